@@ -1,328 +1,2667 @@
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-#include <stdbool.h>
-
-#ifdef _WIN32
-    #include <windows.h>
-#else
-    #include <unistd.h>
-#endif
-
-// --- Constants ---
-#define BANK_FILENAME "bank_accounts.dat"
-#define BANK_MAX_NAME_LENGTH 100
-#define BANK_MAX_TYPE_LENGTH 20 // e.g., "Savings", "Current"
-#define BANK_MAX_ACCOUNTS 1000
-
-// --- Structure Definition ---
-struct Account {
-    long account_number; // Using long for potentially larger numbers
-    char account_holder_name[BANK_MAX_NAME_LENGTH];
-    float balance;
-    char account_type[BANK_MAX_TYPE_LENGTH];
-};
-
-// --- Function Prototypes ---
-// Utility
-void bank_clearScreen();
-void bank_clearInputBuffer();
-void bank_pressEnterToContinue();
-void bank_displayMenu();
-
-// CRUD operations
-void bank_createAccount();
-void bank_displayAllAccounts();
-void bank_searchAccount();
-void bank_depositWithdraw(bool is_deposit); // true for deposit, false for withdraw
-void bank_deleteAccount();
-
-// File I/O helpers
-int bank_loadAccounts(struct Account account_array[]);
-void bank_saveAccounts(struct Account account_array[], int count);
-
-// --- Main Function for Bank System ---
-int main() {
-    int choice;
-    do {
-        bank_clearScreen();
-        bank_displayMenu();
-        printf("Enter your choice: ");
-        while (scanf("%d", &choice) != 1 || choice < 0 || choice > 6) {
-            printf("Invalid choice. Please enter a number between 0 and 6: ");
-            bank_clearInputBuffer(); // Corrected this line
-        }
-        bank_clearInputBuffer(); // Corrected this line as well to ensure it's the bank version
-
-        switch (choice) {
-            case 1: bank_createAccount(); break;
-            case 2: bank_displayAllAccounts(); break;
-            case 3: bank_searchAccount(); break;
-            case 4: bank_depositWithdraw(true); break; // Deposit
-            case 5: bank_depositWithdraw(false); break; // Withdraw
-            case 6: bank_deleteAccount(); break;
-            case 0: printf("\nExiting Bank Management System. Goodbye!\n"); break;
-            default: printf("\nAn unexpected error occurred.\n"); break;
-        }
-        if (choice != 0) {
-            bank_pressEnterToContinue();
-        }
-    } while (choice != 0);
-
-    return 0;
-}
-
-// --- Utility Functions Implementation ---
-void bank_clearScreen() {
-    #ifdef _WIN32
-        system("cls");
-    #else
-        system("clear");
-    #endif
-}
-
-void bank_clearInputBuffer() {
-    int c;
-    while ((c = getchar()) != '\n' && c != EOF);
-}
-
-void bank_pressEnterToContinue() {
-    printf("\nPress Enter to continue...");
-    bank_clearInputBuffer();
-    getchar();
-}
-
-void bank_displayMenu() {
-    printf("=======================================\n");
-    printf("  BANK MANAGEMENT SYSTEM\n");
-    printf("=======================================\n");
-    printf("1. Create New Account\n");
-    printf("2. Display All Accounts\n");
-    printf("3. Search Account\n");
-    printf("4. Deposit Money\n");
-    printf("5. Withdraw Money\n");
-    printf("6. Delete Account\n");
-    printf("0. Exit\n");
-    printf("---------------------------------------\n");
-}
-
-// --- File I/O Helper Functions Implementation ---
-int bank_loadAccounts(struct Account account_array[]) {
-    FILE *fp = fopen(BANK_FILENAME, "rb");
-    if (fp == NULL) return 0;
-
-    int count = 0;
-    while (count < BANK_MAX_ACCOUNTS && fread(&account_array[count], sizeof(struct Account), 1, fp) == 1) {
-        count++;
-    }
-    fclose(fp);
-    return count;
-}
-
-void bank_saveAccounts(struct Account account_array[], int count) {
-    FILE *fp = fopen(BANK_FILENAME, "wb");
-    if (fp == NULL) {
-        perror("Error opening file for saving accounts");
-        return;
-    }
-    fwrite(account_array, sizeof(struct Account), count, fp);
-    fclose(fp);
-}
-
-// --- CRUD Operations Implementation ---
-void bank_createAccount() {
-    bank_clearScreen();
-    printf("--- Create New Account ---\n");
-    struct Account new_acc;
-    struct Account existing_accounts[BANK_MAX_ACCOUNTS];
-    int current_count = bank_loadAccounts(existing_accounts);
-
-    printf("Enter Account Number (e.g., 1001): ");
-    while (scanf("%ld", &new_acc.account_number) != 1 || new_acc.account_number <= 0) {
-        printf("Invalid Account Number. Enter a positive number: ");
-        bank_clearInputBuffer();
-    }
-    bank_clearInputBuffer();
-
-    for (int i = 0; i < current_count; i++) {
-        if (existing_accounts[i].account_number == new_acc.account_number) {
-            printf("Error: Account Number %ld already exists. Please use a unique Account Number.\n", new_acc.account_number);
-            return;
-        }
-    }
-
-    printf("Enter Account Holder Name (max %d chars): ", BANK_MAX_NAME_LENGTH - 1);
-    fgets(new_acc.account_holder_name, BANK_MAX_NAME_LENGTH, stdin);
-    new_acc.account_holder_name[strcspn(new_acc.account_holder_name, "\n")] = 0;
-    if (strlen(new_acc.account_holder_name) == 0) {
-        printf("Account Holder Name cannot be empty. Please try again.\n");
-        return;
-    }
-
-    printf("Enter Initial Balance (0 or more): ");
-    while (scanf("%f", &new_acc.balance) != 1 || new_acc.balance < 0.0) {
-        printf("Invalid Balance. Enter 0 or a positive number: ");
-        bank_clearInputBuffer();
-    }
-    bank_clearInputBuffer();
-
-    printf("Enter Account Type (e.g., Savings, Current - max %d chars): ", BANK_MAX_TYPE_LENGTH - 1);
-    fgets(new_acc.account_type, BANK_MAX_TYPE_LENGTH, stdin);
-    new_acc.account_type[strcspn(new_acc.account_type, "\n")] = 0;
-    if (strlen(new_acc.account_type) == 0) {
-        printf("Account Type cannot be empty. Please try again.\n");
-        return;
-    }
-
-
-    if (current_count < BANK_MAX_ACCOUNTS) {
-        existing_accounts[current_count] = new_acc;
-        current_count++;
-        bank_saveAccounts(existing_accounts, current_count);
-        printf("\nAccount created successfully!\n");
-    } else {
-        printf("\nSystem capacity reached. Cannot create more accounts.\n");
-    }
-}
-
-void bank_displayAllAccounts() {
-    bank_clearScreen();
-    printf("--- All Bank Accounts ---\n");
-    struct Account accounts[BANK_MAX_ACCOUNTS];
-    int count = bank_loadAccounts(accounts);
-
-    if (count == 0) {
-        printf("\nNo bank accounts found.\n");
-        return;
-    }
-
-    printf("--------------------------------------------------------------------------------------\n");
-    printf("%-15s %-*s %-15s %-15s\n", "Account No.", BANK_MAX_NAME_LENGTH, "Holder Name", "Balance", "Type");
-    printf("--------------------------------------------------------------------------------------\n");
-    for (int i = 0; i < count; i++) {
-        printf("%-15ld %-*s %-15.2f %-15s\n",
-               accounts[i].account_number,
-               BANK_MAX_NAME_LENGTH, accounts[i].account_holder_name,
-               accounts[i].balance, accounts[i].account_type);
-    }
-    printf("--------------------------------------------------------------------------------------\n");
-}
-
-void bank_searchAccount() {
-    bank_clearScreen();
-    printf("--- Search Account ---\n");
-    long search_acc_num;
-    bool found = false;
-
-    printf("Enter Account Number to search: ");
-    while (scanf("%ld", &search_acc_num) != 1 || search_acc_num <= 0) {
-        printf("Invalid Account Number. Enter a positive number: ");
-        bank_clearInputBuffer();
-    }
-    bank_clearInputBuffer();
-
-    struct Account accounts[BANK_MAX_ACCOUNTS];
-    int count = bank_loadAccounts(accounts);
-
-    for (int i = 0; i < count; i++) {
-        if (accounts[i].account_number == search_acc_num) {
-            printf("\nAccount Found:\n");
-            printf("Account Number: %ld\nHolder Name: %s\nBalance: %.2f\nType: %s\n",
-                   accounts[i].account_number, accounts[i].account_holder_name,
-                   accounts[i].balance, accounts[i].account_type);
-            found = true;
-            break;
-        }
-    }
-
-    if (!found) {
-        printf("\nAccount with Number %ld not found.\n", search_acc_num);
-    }
-}
-
-void bank_depositWithdraw(bool is_deposit) {
-    bank_clearScreen();
-    printf("--- %s Money ---\n", is_deposit ? "Deposit" : "Withdraw");
-    long acc_num;
-    float amount;
-    bool found = false;
-
-    printf("Enter Account Number: ");
-    while (scanf("%ld", &acc_num) != 1 || acc_num <= 0) {
-        printf("Invalid Account Number. Enter a positive number: ");
-        bank_clearInputBuffer();
-    }
-    bank_clearInputBuffer();
-
-    printf("Enter Amount to %s: ", is_deposit ? "Deposit" : "Withdraw");
-    while (scanf("%f", &amount) != 1 || amount <= 0) {
-        printf("Invalid Amount. Enter a positive number: ");
-        bank_clearInputBuffer();
-    }
-    bank_clearInputBuffer();
-
-    struct Account accounts[BANK_MAX_ACCOUNTS];
-    int count = bank_loadAccounts(accounts);
-
-    for (int i = 0; i < count; i++) {
-        if (accounts[i].account_number == acc_num) {
-            found = true;
-            if (is_deposit) {
-                accounts[i].balance += amount;
-                printf("\nDeposit successful! New balance for %ld: %.2f\n", acc_num, accounts[i].balance);
-            } else { // Withdraw
-                if (accounts[i].balance >= amount) {
-                    accounts[i].balance -= amount;
-                    printf("\nWithdrawal successful! New balance for %ld: %.2f\n", acc_num, accounts[i].balance);
-                } else {
-                    printf("\nInsufficient balance for withdrawal. Current balance: %.2f\n", accounts[i].balance);
-                }
-            }
-            bank_saveAccounts(accounts, count); // Save changes
-            break;
-        }
-    }
-
-    if (!found) {
-        printf("\nAccount with Number %ld not found.\n", acc_num);
-    }
-}
-
-void bank_deleteAccount() {
-    bank_clearScreen();
-    printf("--- Delete Account ---\n");
-    long delete_acc_num;
-    bool found = false;
-    int delete_index = -1;
-
-    printf("Enter Account Number to delete: ");
-    while (scanf("%ld", &delete_acc_num) != 1 || delete_acc_num <= 0) {
-        printf("Invalid Account Number. Enter a positive number: ");
-        bank_clearInputBuffer();
-    }
-    bank_clearInputBuffer();
-
-    struct Account accounts[BANK_MAX_ACCOUNTS];
-    int count = bank_loadAccounts(accounts);
-
-    for (int i = 0; i < count; i++) {
-        if (accounts[i].account_number == delete_acc_num) {
-            found = true;
-            delete_index = i;
-            break;
-        }
-    }
-
-    if (!found) {
-        printf("\nAccount with Number %ld not found.\n", delete_acc_num);
-        return;
-    }
-
-    for (int i = delete_index; i < count - 1; i++) {
-        accounts[i] = accounts[i+1];
-    }
-    count--;
-
-    bank_saveAccounts(accounts, count);
-    printf("\nAccount with Number %ld deleted successfully!\n", delete_acc_num);
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+#include <errno.h>
+#include <limits.h>
+#include <ctype.h>
+
+#ifdef _WIN32
+    #include <windows.h>
+    #include <io.h>
+#else
+    #include <unistd.h>
+    #include <fcntl.h>
+    #include <sys/wait.h>
+#endif
+#ifdef __linux__
+    #include <sys/ioctl.h>
+    #include <linux/fs.h> // FICLONE
+#endif
+
+#include "record_store.h"
+#include "bench.h"
+
+// --- Constants ---
+#define BANK_FILENAME "bank_accounts.dat"
+#define BANK_HOLDERS_FILENAME "bank_holders" // + ".<generation>": holder names the data file refers to
+#define BANK_FORMAT_MAGIC "BANKACC" // First 8 bytes of a data file in the current format
+#define BANK_FORMAT_VERSION 2 // 1: raw struct Account records, no header
+#define BANK_MAX_ACCOUNT_TYPES 64 // Size of the account type dictionary in the file header
+#define BANK_MAX_NAME_LENGTH 100
+#define BANK_MAX_TYPE_LENGTH 20 // e.g., "Savings", "Current"
+#define BANK_MAX_SEARCH_RESULTS 50 // Name matches shown at once
+#define BANK_PAGE_SIZE 25 // Rows per page of the account listing
+#define BANK_NAME_COLUMN_WIDTH 30 // Holder names are cut to this width in the listing
+#define BANK_MAX_LINE_LENGTH 256 // Longest accepted line in a batch file
+#define BANK_IO_CHUNK 4096 // Records per read/write when streaming through a whole file
+#define BANK_INDEX_FILENAME "bank_accounts.idx" // Sorted (account_number -> slot) index
+#define BANK_NAME_INDEX_FILENAME "bank_names.idx" // Sorted (lower-cased holder name, account_number) index
+#define BANK_JOURNAL_FILENAME "bank_journal.log" // Append-only write-ahead log of account changes
+#define BANK_TEMP_FILENAME "bank_accounts.tmp"
+#define BANK_INDEX_TEMP_FILENAME "bank_accounts.idx.tmp"
+#define BANK_FREE_FILENAME "bank_free.lst" // Stack of tombstoned slots that new accounts reuse
+#define BANK_TOMBSTONE 0 // account_number of a deleted record; real account numbers are positive
+#define BANK_COMPACT_MIN_FREE 256 // Tombstones tolerated before compaction is considered
+#define BANK_COMPACT_RATIO 4 // Compact once more than 1 in this many slots is a tombstone
+#define BANK_GROUP_COMMIT_SIZE 64 // Journal records made durable by a single fsync
+#define BANK_CHECKPOINT_INTERVAL 1024 // Journal records applied before it is folded into the data file
+#define BANK_LOCK_FILENAME "bank_accounts.lock" // Byte-range locks shared by every running instance
+#define BANK_LOCK_STRIPES 1024 // Account locks; accounts hash onto a stripe
+#define BANK_MAX_RATE_RULES 16 // Account types one interest/fee run can cover
+#define BANK_SNAPSHOT_FILENAME "bank_accounts.snap" // Suffixed with the process id of the report reading it
+#define BANK_REPORT_TOP 10 // Largest balances listed by a report unless another count is given
+#define BANK_BLOOM_BITS_PER_KEY 10 // Existence filter size; about 1% false positives with 4 probes
+#define BANK_BLOOM_MIN_BITS 65536
+#define BANK_MAX_CHANGE_RECORDS 2 // Journal records written by one change (a transfer writes two)
+#define BANK_BENCH_DIR "bank_bench" // Scratch directory for --bench; the real account files are never touched
+#define BANK_BENCH_RECORDS 10000 // Accounts generated by --bench unless another count is given
+#define BANK_BENCH_OPERATIONS 200 // Timed repetitions of each benchmark operation unless another count is given
+#define BANK_BENCH_RATE_RECORDS 10000000 // Accounts generated by --bench-rates unless another count is given
+#define BANK_BENCH_RATE_RUNS 5 // Timed passes of bank_applyRates in --bench-rates
+
+// Balances are whole cents so arithmetic is exact; print them with these.
+#define BANK_MONEY_FMT "%lld.%02lld"
+#define BANK_MONEY_ARGS(cents) (long long)(cents) / 100, (long long)(cents) % 100
+
+// --- Structure Definition ---
+// An account as the program works with it. Version 1 data files stored this struct raw.
+struct Account {
+    long account_number; // Using long for potentially larger numbers
+    char account_holder_name[BANK_MAX_NAME_LENGTH];
+    long long balance; // In cents
+    char account_type[BANK_MAX_TYPE_LENGTH];
+};
+
+// Record layout written before balances were stored in cents; read only by --migrate-balances.
+struct LegacyAccount {
+    long account_number;
+    char account_holder_name[BANK_MAX_NAME_LENGTH];
+    float balance;
+    char account_type[BANK_MAX_TYPE_LENGTH];
+};
+
+/*
+ * Data file format, version 2: a BankFileHeader followed by fixed-size
+ * StoredAccount records, so a record is still found by slot and updated in
+ * place. Account types are stored once, in the header's dictionary, and holder
+ * names live in a separate append-only file; a record refers to both. Scans
+ * that only need numbers, balances and types read 32 bytes per account instead
+ * of 144. The holders file is replaced (under a new generation number) only
+ * when the data file is rewritten by compaction or conversion.
+ */
+struct BankFileHeader {
+    char magic[8];                   // BANK_FORMAT_MAGIC
+    unsigned int version;            // BANK_FORMAT_VERSION
+    unsigned int record_size;        // sizeof(struct StoredAccount)
+    unsigned int type_count;         // Entries used in types; codes are never reused or renumbered
+    unsigned int holders_generation; // Selects the holders file
+    char types[BANK_MAX_ACCOUNT_TYPES][BANK_MAX_TYPE_LENGTH];
+    unsigned int checksum;           // FNV-1a of the header up to this field
+};
+
+struct StoredAccount {
+    long long account_number; // BANK_TOMBSTONE for a deleted slot
+    long long balance;        // In cents
+    long long name_offset;    // Position of the holder name in the holders file
+    unsigned char name_length;
+    unsigned char type_code;  // Index into the header's type dictionary
+    unsigned short reserved;
+    unsigned int checksum;    // FNV-1a of the record up to this field
+};
+
+// One entry of the index file. Entries are kept sorted by account_number so a
+// lookup is a binary search over the index instead of a scan of every account.
+struct AccountIndexEntry {
+    long account_number;
+    long slot; // Record position in BANK_FILENAME (0-based)
+};
+
+// Running totals for one account type (by type code) in a balance report
+struct TypeTotal {
+    long count;
+    long long balance;
+};
+
+// Interest (positive) or fee (negative) for every account of one type, in basis points (1/100 of a percent)
+struct RateRule {
+    char account_type[BANK_MAX_TYPE_LENGTH];
+    long long basis_points;
+};
+
+// One entry of the holder-name index, sorted by folded_name then account_number.
+// Exact and prefix searches are a binary search followed by a scan of the matches.
+struct NameIndexEntry {
+    char folded_name[BANK_MAX_NAME_LENGTH]; // Lower-cased holder name, zero-padded
+    long account_number;
+};
+
+// Orders offered by the account listing
+enum BankListingOrder {
+    BANK_ORDER_STORED = 1,
+    BANK_ORDER_NUMBER,
+    BANK_ORDER_BALANCE_DESC,
+    BANK_ORDER_BALANCE_ASC
+};
+
+// Streams accounts for the listing in the chosen order without holding the table:
+// stored order reads the data file a chunk at a time, number order walks the
+// index, and balance order sorts only (balance, slot) pairs.
+struct BalanceSlot {
+    long long balance;
+    long slot;
+};
+
+struct ListingCursor {
+    int order;
+    int type_code; // -1: every account type
+    struct BankFileHeader header;
+    FILE *data;
+    FILE *holders;
+    FILE *idx;
+    struct StoredAccount *chunk;
+    long chunk_count, chunk_pos;
+    struct BalanceSlot *sorted;
+    long sorted_count, sorted_pos;
+};
+
+// Result codes shared by the interactive menu and batch mode
+enum BankStatus {
+    BANK_STATUS_OK = 0,
+    BANK_STATUS_NOT_FOUND,
+    BANK_STATUS_EXISTS,
+    BANK_STATUS_INSUFFICIENT_FUNDS,
+    BANK_STATUS_INVALID,
+    BANK_STATUS_IO_ERROR
+};
+
+// Journal operations. Each journal record carries the account's after-image,
+// so replaying a record that was already applied leaves the data unchanged.
+enum BankJournalOp {
+    BANK_OP_CREATE = 1,
+    BANK_OP_UPDATE = 2,
+    BANK_OP_DELETE = 3
+};
+
+// Lock modes, and the byte offsets locked in BANK_LOCK_FILENAME. Record changes
+// hold the table lock shared plus their account's stripe; creates, deletes and
+// checkpoints hold the table lock exclusively.
+enum BankLockMode {
+    BANK_LOCK_NONE = 0,
+    BANK_LOCK_SHARED,
+    BANK_LOCK_EXCLUSIVE
+};
+
+enum BankLockOffset {
+    BANK_LOCK_TABLE = 0,
+    BANK_LOCK_JOURNAL = 1,
+    BANK_LOCK_FIRST_STRIPE = 2
+};
+
+// The records of one change are written together and share a group: the
+// sequence of its first record. Replay applies a group only once all
+// group_size records are there, so a change torn by a crash is dropped even
+// when another instance appended after it.
+struct JournalRecord {
+    long sequence;              // 1-based position in the journal; a mismatch marks a torn tail
+    long group;                 // Sequence of the first record of the change
+    unsigned long long writer;  // Session that logged it (bank_writer_id)
+    int op;                     // One of BankJournalOp
+    int group_size;             // Records in the change, 1 to BANK_MAX_CHANGE_RECORDS
+    unsigned int checksum;      // FNV-1a of the record with this field zeroed
+    struct Account account;     // After-image (only account_number is used for deletes)
+};
+
+// --- Function Prototypes ---
+// Utility
+void bank_clearScreen();
+void bank_clearInputBuffer();
+void bank_pressEnterToContinue();
+void bank_displayMenu();
+
+// CRUD operations
+void bank_createAccount();
+void bank_displayAllAccounts();
+void bank_searchAccount();
+void bank_depositWithdraw(bool is_deposit); // true for deposit, false for withdraw
+void bank_transferMoney();
+void bank_applyInterestFees();
+void bank_deleteAccount();
+void bank_balanceReport();
+
+// Account operations (log the change; the caller decides when to commit)
+int bank_openAccount(const struct Account *acc);
+int bank_adjustBalance(long account_number, long long amount, bool is_deposit, struct Account *acc);
+int bank_transfer(long from_account, long to_account, long long amount, struct Account *from, struct Account *to);
+int bank_closeAccount(long account_number);
+long bank_applyRates(const struct RateRule rules[], int rule_count, long *changed);
+bool bank_parseRate(const char *text, long long *basis_points);
+bool bank_parseMoney(const char *text, long long *cents);
+long long bank_readMoney(bool allow_zero);
+
+// Batch mode
+int bank_runBatch(const char *filename);
+int bank_runLoadTest(int clients, long transactions_per_client);
+int bank_convertLegacy(bool float_balances);
+int bank_runApplyRates(int rule_count, char *rule_args[]);
+int bank_runReport(int top_count);
+int bank_runBench(long records, int operations);
+int bank_runRateBench(long records);
+
+// Snapshot reports
+bool bank_copyFile(const char *source, const char *dest);
+bool bank_takeSnapshot(char *path, char *holders_path, size_t path_size);
+
+// Listing helpers
+bool bank_openListing(struct ListingCursor *cursor, int order, const char *type_filter);
+bool bank_nextListed(struct ListingCursor *cursor, struct Account *acc);
+void bank_closeListing(struct ListingCursor *cursor);
+
+// File I/O helpers
+bool bank_readAccountAt(FILE *fp, long slot, struct Account *acc);
+bool bank_writeAccountAt(FILE *fp, long slot, const struct Account *acc);
+bool bank_writeTombstoneAt(FILE *fp, long slot);
+
+// Record format helpers
+void bank_initHeader(struct BankFileHeader *header, unsigned int holders_generation);
+bool bank_readHeader(FILE *fp, struct BankFileHeader *header);
+bool bank_writeHeader(FILE *fp, struct BankFileHeader *header);
+bool bank_checkFormat();
+void bank_holdersPath(char *path, size_t path_size, unsigned int generation);
+FILE *bank_holdersFile(const struct BankFileHeader *header);
+int bank_findTypeCode(const struct BankFileHeader *header, const char *account_type);
+bool bank_encodeAccount(struct BankFileHeader *header, FILE *holders, const struct Account *acc, struct StoredAccount *rec);
+bool bank_decodeAccount(const struct BankFileHeader *header, FILE *holders, const struct StoredAccount *rec, struct Account *acc);
+
+// Index helpers
+void bank_ensureIndex();
+void bank_rebuildIndex();
+void bank_rebuildNameIndex();
+void bank_indexRemove(long account_number);
+long bank_findAccountSlot(long account_number);
+void bank_indexInsert(long account_number, long slot);
+void bank_foldName(const char *name, char folded[BANK_MAX_NAME_LENGTH]);
+long bank_findByName(const char *prefix, long account_numbers[], long max_results);
+
+// Free list and compaction
+long bank_countFreeSlots();
+void bank_pushFreeSlot(long slot);
+long bank_peekFreeSlot();
+void bank_popFreeSlot();
+long bank_compact();
+
+// Locking helpers (coordinate concurrent instances)
+void bank_openLockFile();
+bool bank_lockRange(long offset, long length, int mode, bool wait);
+bool bank_beginChange(bool structural, const long account_numbers[], int count);
+void bank_releaseLocks();
+int bank_rejectChange(int status);
+
+// Existence filter (answers "certainly not an account" without touching the index)
+bool bank_accountExists(long account_number);
+void bank_rebuildFilter(long long version);
+void bank_filterAdd(long account_number);
+bool bank_filterMayContain(long account_number);
+long long bank_readCreateCount();
+void bank_countCreate();
+
+// Journal (write-ahead log) helpers
+void bank_openJournal();
+void bank_closeJournal();
+bool bank_lookupAccount(long account_number, struct Account *acc);
+bool bank_logTransaction(int op, const struct Account *acc);
+bool bank_logTransactionGroup(const int ops[], const struct Account accs[], int count);
+void bank_commitTransactions();
+long bank_replayJournal(bool skip_own);
+long bank_checkpoint();
+void bank_applyTransaction(int op, const struct Account *acc);
+
+// --- Main Function for Bank System ---
+int main(int argc, char *argv[]) {
+    int choice;
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0) { // Works in its own directory, so it opens its own files
+        return bank_runBench(argc > 2 ? atol(argv[2]) : BANK_BENCH_RECORDS, argc > 3 ? atoi(argv[3]) : BANK_BENCH_OPERATIONS);
+    }
+    if (argc > 1 && strcmp(argv[1], "--bench-rates") == 0) {
+        return bank_runRateBench(argc > 2 ? atol(argv[2]) : BANK_BENCH_RATE_RECORDS);
+    }
+    bank_openLockFile();
+    // Conversions run before the journal: its replay expects the current format.
+    if (argc > 1 && strcmp(argv[1], "--migrate-balances") == 0) {
+        return bank_convertLegacy(true);
+    }
+    if (argc > 1 && strcmp(argv[1], "--convert-format") == 0) {
+        return bank_convertLegacy(false);
+    }
+    if (!bank_checkFormat()) return 1;
+    bank_openJournal();
+
+    if (argc > 1) {
+        if (strcmp(argv[1], "--batch") == 0) {
+            int status = bank_runBatch(argc > 2 ? argv[2] : "-");
+            bank_closeJournal();
+            return status;
+        }
+        if (strcmp(argv[1], "--apply-rates") == 0 && argc > 2) {
+            int status = bank_runApplyRates(argc - 2, argv + 2);
+            bank_closeJournal();
+            return status;
+        }
+        if (strcmp(argv[1], "--compact") == 0) {
+            bank_commitTransactions();
+            bank_lockRange(BANK_LOCK_TABLE, 1, BANK_LOCK_EXCLUSIVE, true);
+            long reclaimed = bank_compact();
+            bank_releaseLocks();
+            if (reclaimed >= 0) printf("Compaction reclaimed %ld deleted slot(s).\n", reclaimed);
+            bank_closeJournal();
+            return reclaimed >= 0 ? 0 : 1;
+        }
+        if (strcmp(argv[1], "--report") == 0) {
+            int status = bank_runReport(argc > 2 ? atoi(argv[2]) : BANK_REPORT_TOP);
+            bank_closeJournal();
+            return status;
+        }
+        if (strcmp(argv[1], "--load-test") == 0 && argc > 3) {
+            int status = bank_runLoadTest(atoi(argv[2]), atol(argv[3]));
+            bank_closeJournal();
+            return status;
+        }
+        printf("Usage: %s [--batch <file>|-] [--load-test <clients> <transactions-per-client>]\n"
+               "       [--apply-rates <type>=<percent>...] [--report [top-count]] [--compact]\n"
+               "       [--convert-format] [--migrate-balances] [--bench [records] [operations]]\n"
+               "       [--bench-rates [records]]\n", argv[0]);
+        bank_closeJournal();
+        return 1;
+    }
+
+    do {
+        bank_clearScreen();
+        bank_displayMenu();
+        printf("Enter your choice: ");
+        while (scanf("%d", &choice) != 1 || choice < 0 || choice > 9) {
+            printf("Invalid choice. Please enter a number between 0 and 9: ");
+            bank_clearInputBuffer(); // Corrected this line
+        }
+        bank_clearInputBuffer(); // Corrected this line as well to ensure it's the bank version
+
+        switch (choice) {
+            case 1: bank_createAccount(); break;
+            case 2: bank_displayAllAccounts(); break;
+            case 3: bank_searchAccount(); break;
+            case 4: bank_depositWithdraw(true); break; // Deposit
+            case 5: bank_depositWithdraw(false); break; // Withdraw
+            case 6: bank_deleteAccount(); break;
+            case 7: bank_transferMoney(); break;
+            case 8: bank_applyInterestFees(); break;
+            case 9: bank_balanceReport(); break;
+            case 0: printf("\nExiting Bank Management System. Goodbye!\n"); break;
+            default: printf("\nAn unexpected error occurred.\n"); break;
+        }
+        if (choice != 0) {
+            bank_pressEnterToContinue();
+        }
+    } while (choice != 0);
+
+    bank_closeJournal();
+    return 0;
+}
+
+// --- Utility Functions Implementation ---
+void bank_clearScreen() {
+    #ifdef _WIN32
+        system("cls");
+    #else
+        system("clear");
+    #endif
+}
+
+void bank_clearInputBuffer() {
+    int c;
+    while ((c = getchar()) != '\n' && c != EOF);
+}
+
+void bank_pressEnterToContinue() {
+    printf("\nPress Enter to continue...");
+    bank_clearInputBuffer();
+    getchar();
+}
+
+void bank_displayMenu() {
+    printf("=======================================\n");
+    printf("  BANK MANAGEMENT SYSTEM\n");
+    printf("=======================================\n");
+    printf("1. Create New Account\n");
+    printf("2. Display All Accounts\n");
+    printf("3. Search Account\n");
+    printf("4. Deposit Money\n");
+    printf("5. Withdraw Money\n");
+    printf("6. Delete Account\n");
+    printf("7. Transfer Money\n");
+    printf("8. Apply Interest/Fees by Account Type\n");
+    printf("9. Balance Report\n");
+    printf("0. Exit\n");
+    printf("---------------------------------------\n");
+}
+
+// --- File I/O Helper Functions Implementation ---
+static FILE *bank_holders = NULL;
+static unsigned int bank_holders_generation = 0;
+
+// The data file as a record store: StoredAccount records after the header, keyed by account number
+static const struct RecordStore bank_store = {
+    BANK_FILENAME, sizeof(struct StoredAccount), offsetof(struct StoredAccount, account_number),
+    sizeof(long long), (long)sizeof(struct BankFileHeader), NULL, // The header is managed by bank_writeHeader
+    NULL, NULL // bank_ keeps its own key index and free list (BANK_INDEX_FILENAME, BANK_FREE_FILENAME)
+};
+
+// FNV-1a, used for data file records and journal records.
+static unsigned int bank_checksum(const void *data, size_t size) {
+    const unsigned char *bytes = (const unsigned char *)data;
+    unsigned int hash = 2166136261u;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+// Reads the account in a slot of the data file; false for a tombstone or a damaged record.
+bool bank_readAccountAt(FILE *fp, long slot, struct Account *acc) {
+    struct BankFileHeader header;
+    struct StoredAccount rec;
+    if (!bank_readHeader(fp, &header) || !rs_readAt(&bank_store, fp, slot, &rec) || rec.account_number == BANK_TOMBSTONE) {
+        return false;
+    }
+    return bank_decodeAccount(&header, bank_holdersFile(&header), &rec, acc);
+}
+
+// Overwrites a single record in place; fp must be opened with "r+b". A new account
+// type is added to the header's dictionary, and the holder name is appended to the
+// holders file unless the slot already holds the same account under the same name.
+bool bank_writeAccountAt(FILE *fp, long slot, const struct Account *acc) {
+    struct BankFileHeader header;
+    if (!bank_readHeader(fp, &header)) return false;
+    unsigned int type_count = header.type_count;
+    FILE *holders = bank_holdersFile(&header);
+    struct StoredAccount rec, previous;
+    struct Account stored;
+    if (rs_readAt(&bank_store, fp, slot, &previous) && previous.account_number == acc->account_number &&
+        bank_decodeAccount(&header, holders, &previous, &stored) &&
+        strcmp(stored.account_holder_name, acc->account_holder_name) == 0 &&
+        strcmp(stored.account_type, acc->account_type) == 0) {
+        rec = previous;
+        rec.balance = acc->balance;
+        rec.checksum = bank_checksum(&rec, offsetof(struct StoredAccount, checksum));
+    } else if (!bank_encodeAccount(&header, holders, acc, &rec)) {
+        return false;
+    }
+    if (header.type_count != type_count && !bank_writeHeader(fp, &header)) return false;
+    return rs_writeAt(&bank_store, fp, slot, &rec);
+}
+
+bool bank_writeTombstoneAt(FILE *fp, long slot) {
+    struct StoredAccount rec;
+    memset(&rec, 0, sizeof(rec)); // account_number BANK_TOMBSTONE
+    rec.checksum = bank_checksum(&rec, offsetof(struct StoredAccount, checksum));
+    return rs_writeAt(&bank_store, fp, slot, &rec);
+}
+
+// --- Record Format Helper Functions Implementation ---
+void bank_initHeader(struct BankFileHeader *header, unsigned int holders_generation) {
+    memset(header, 0, sizeof(struct BankFileHeader));
+    memcpy(header->magic, BANK_FORMAT_MAGIC, sizeof(header->magic));
+    header->version = BANK_FORMAT_VERSION;
+    header->record_size = sizeof(struct StoredAccount);
+    header->holders_generation = holders_generation;
+}
+
+// Reads and validates the header at the start of a data file.
+bool bank_readHeader(FILE *fp, struct BankFileHeader *header) {
+    if (fseek(fp, 0, SEEK_SET) != 0 || fread(header, sizeof(struct BankFileHeader), 1, fp) != 1) return false;
+    return memcmp(header->magic, BANK_FORMAT_MAGIC, sizeof(header->magic)) == 0 &&
+           header->version == BANK_FORMAT_VERSION &&
+           header->record_size == sizeof(struct StoredAccount) &&
+           header->type_count <= BANK_MAX_ACCOUNT_TYPES &&
+           header->checksum == bank_checksum(header, offsetof(struct BankFileHeader, checksum));
+}
+
+bool bank_writeHeader(FILE *fp, struct BankFileHeader *header) {
+    header->checksum = bank_checksum(header, offsetof(struct BankFileHeader, checksum));
+    return fseek(fp, 0, SEEK_SET) == 0 && fwrite(header, sizeof(struct BankFileHeader), 1, fp) == 1;
+}
+
+// Creates an empty data file if there is none. Returns false, after saying how to
+// convert it, if the existing file is not in the current format.
+bool bank_checkFormat() {
+    struct BankFileHeader header;
+    bank_lockRange(BANK_LOCK_TABLE, 1, BANK_LOCK_EXCLUSIVE, true);
+    FILE *fp = fopen(BANK_FILENAME, "rb");
+    bool ok;
+    if (fp != NULL) {
+        ok = bank_readHeader(fp, &header);
+        fclose(fp);
+        if (!ok) {
+            printf("%s is not in the current format (version %d). Convert it with --convert-format,\n"
+                   "or with --migrate-balances if it was written when balances were stored as floats.\n",
+                   BANK_FILENAME, BANK_FORMAT_VERSION);
+        }
+    } else {
+        fp = fopen(BANK_FILENAME, "wb");
+        bank_initHeader(&header, 1);
+        ok = fp != NULL && bank_writeHeader(fp, &header);
+        if (fp != NULL) fclose(fp);
+        if (!ok) perror("Error creating accounts file");
+    }
+    bank_lockRange(BANK_LOCK_TABLE, 1, BANK_LOCK_NONE, false);
+    return ok;
+}
+
+void bank_holdersPath(char *path, size_t path_size, unsigned int generation) {
+    snprintf(path, path_size, "%s.%u", BANK_HOLDERS_FILENAME, generation);
+}
+
+// Returns the holders file for the header's generation, kept open for reads and
+// appends; it is reopened when another generation is asked for.
+FILE *bank_holdersFile(const struct BankFileHeader *header) {
+    if (bank_holders != NULL && bank_holders_generation == header->holders_generation) return bank_holders;
+    if (bank_holders != NULL) fclose(bank_holders);
+    char path[64];
+    bank_holdersPath(path, sizeof(path), header->holders_generation);
+    bank_holders = fopen(path, "a+b"); // Writes always append; reads seek first
+    bank_holders_generation = header->holders_generation;
+    if (bank_holders == NULL) perror("Error opening holder names file");
+    return bank_holders;
+}
+
+// Returns the dictionary code of an account type, or -1 if it has none yet.
+int bank_findTypeCode(const struct BankFileHeader *header, const char *account_type) {
+    for (unsigned int i = 0; i < header->type_count; i++) {
+        if (strncmp(header->types[i], account_type, BANK_MAX_TYPE_LENGTH) == 0) return (int)i;
+    }
+    return -1;
+}
+
+// Builds the stored form of an account: appends its holder name to holders and
+// looks up (or adds to the in-memory header) the code of its type. False if the
+// type dictionary is full or the name cannot be written.
+bool bank_encodeAccount(struct BankFileHeader *header, FILE *holders, const struct Account *acc, struct StoredAccount *rec) {
+    int code = bank_findTypeCode(header, acc->account_type);
+    if (code < 0) {
+        if (header->type_count == BANK_MAX_ACCOUNT_TYPES) {
+            printf("Error: No room for account type \"%s\"; at most %d types are supported.\n",
+                   acc->account_type, BANK_MAX_ACCOUNT_TYPES);
+            return false;
+        }
+        code = (int)header->type_count++;
+        memset(header->types[code], 0, BANK_MAX_TYPE_LENGTH);
+        memcpy(header->types[code], acc->account_type, strnlen(acc->account_type, BANK_MAX_TYPE_LENGTH - 1));
+    }
+
+    memset(rec, 0, sizeof(struct StoredAccount));
+    rec->account_number = acc->account_number;
+    rec->balance = acc->balance;
+    rec->name_length = (unsigned char)strnlen(acc->account_holder_name, BANK_MAX_NAME_LENGTH - 1);
+    rec->type_code = (unsigned char)code;
+    if (holders == NULL || fseek(holders, 0, SEEK_END) != 0) return false;
+    rec->name_offset = ftell(holders);
+    if (fwrite(acc->account_holder_name, 1, rec->name_length, holders) != rec->name_length || fflush(holders) != 0) {
+        perror("Error saving holder name");
+        return false;
+    }
+    rec->checksum = bank_checksum(rec, offsetof(struct StoredAccount, checksum));
+    return true;
+}
+
+// Expands a stored record; false (with a warning) if it fails its checksum.
+bool bank_decodeAccount(const struct BankFileHeader *header, FILE *holders, const struct StoredAccount *rec, struct Account *acc) {
+    if (rec->checksum != bank_checksum(rec, offsetof(struct StoredAccount, checksum)) ||
+        rec->type_code >= header->type_count || rec->name_length >= BANK_MAX_NAME_LENGTH) {
+        printf("Warning: The record of account %lld is damaged and was skipped.\n", rec->account_number);
+        return false;
+    }
+    memset(acc, 0, sizeof(struct Account));
+    acc->account_number = (long)rec->account_number;
+    acc->balance = rec->balance;
+    memcpy(acc->account_type, header->types[rec->type_code], BANK_MAX_TYPE_LENGTH);
+    return holders != NULL && fseek(holders, (long)rec->name_offset, SEEK_SET) == 0 &&
+           fread(acc->account_holder_name, 1, rec->name_length, holders) == rec->name_length;
+}
+
+// --- Listing Helper Functions Implementation ---
+static int bank_compareBalanceSlots(const void *a, const void *b) {
+    long long lhs = ((const struct BalanceSlot *)a)->balance;
+    long long rhs = ((const struct BalanceSlot *)b)->balance;
+    return (lhs > rhs) - (lhs < rhs);
+}
+
+static bool bank_matchesFilter(const struct ListingCursor *cursor, const struct StoredAccount *rec) {
+    if (rec->account_number == BANK_TOMBSTONE) return false;
+    return cursor->type_code < 0 || rec->type_code == cursor->type_code;
+}
+
+bool bank_openListing(struct ListingCursor *cursor, int order, const char *type_filter) {
+    memset(cursor, 0, sizeof(struct ListingCursor));
+    cursor->order = order;
+    cursor->data = fopen(BANK_FILENAME, "rb");
+    cursor->chunk = (struct StoredAccount *)malloc(BANK_IO_CHUNK * sizeof(struct StoredAccount));
+    if (cursor->data == NULL || cursor->chunk == NULL || !bank_readHeader(cursor->data, &cursor->header)) {
+        bank_closeListing(cursor);
+        return false;
+    }
+    // Its own handle on this generation's names, in case compaction replaces the files mid-listing.
+    char path[64];
+    bank_holdersPath(path, sizeof(path), cursor->header.holders_generation);
+    cursor->holders = fopen(path, "rb");
+    cursor->type_code = -1;
+    if (type_filter[0] != '\0') {
+        cursor->type_code = bank_findTypeCode(&cursor->header, type_filter);
+        if (cursor->type_code < 0) cursor->type_code = BANK_MAX_ACCOUNT_TYPES; // Unknown type: matches nothing
+    }
+
+    if (order == BANK_ORDER_NUMBER) {
+        cursor->idx = fopen(BANK_INDEX_FILENAME, "rb");
+        if (cursor->idx == NULL) {
+            bank_closeListing(cursor);
+            return false;
+        }
+    } else if (order == BANK_ORDER_BALANCE_DESC || order == BANK_ORDER_BALANCE_ASC) {
+        long capacity = 0;
+        size_t n;
+        while ((n = fread(cursor->chunk, sizeof(struct StoredAccount), BANK_IO_CHUNK, cursor->data)) > 0) {
+            for (size_t i = 0; i < n; i++) {
+                if (!bank_matchesFilter(cursor, &cursor->chunk[i])) continue;
+                if (cursor->sorted_count == capacity) {
+                    capacity = capacity * 2 + BANK_IO_CHUNK;
+                    struct BalanceSlot *grown = (struct BalanceSlot *)realloc(cursor->sorted, capacity * sizeof(struct BalanceSlot));
+                    if (grown == NULL) {
+                        printf("Error: Not enough memory to sort the accounts.\n");
+                        bank_closeListing(cursor);
+                        return false;
+                    }
+                    cursor->sorted = grown;
+                }
+                cursor->sorted[cursor->sorted_count].balance = cursor->chunk[i].balance;
+                cursor->sorted[cursor->sorted_count].slot = cursor->chunk_pos + (long)i;
+                cursor->sorted_count++;
+            }
+            cursor->chunk_pos += (long)n;
+        }
+        if (cursor->sorted_count > 0) {
+            qsort(cursor->sorted, cursor->sorted_count, sizeof(struct BalanceSlot), bank_compareBalanceSlots);
+        }
+        cursor->chunk_pos = 0;
+    }
+    return true;
+}
+
+// Produces the next account that passes the type filter; false once the listing is exhausted.
+bool bank_nextListed(struct ListingCursor *cursor, struct Account *acc) {
+    struct StoredAccount rec;
+    while (true) {
+        if (cursor->order == BANK_ORDER_STORED) {
+            if (cursor->chunk_pos == cursor->chunk_count) {
+                cursor->chunk_count = (long)fread(cursor->chunk, sizeof(struct StoredAccount), BANK_IO_CHUNK, cursor->data);
+                cursor->chunk_pos = 0;
+                if (cursor->chunk_count == 0) return false;
+            }
+            rec = cursor->chunk[cursor->chunk_pos++];
+        } else if (cursor->order == BANK_ORDER_NUMBER) {
+            struct AccountIndexEntry entry;
+            if (fread(&entry, sizeof(struct AccountIndexEntry), 1, cursor->idx) != 1) return false;
+            if (!rs_readAt(&bank_store, cursor->data, entry.slot, &rec)) continue;
+        } else {
+            if (cursor->sorted_pos == cursor->sorted_count) return false;
+            long pos = cursor->order == BANK_ORDER_BALANCE_DESC ? cursor->sorted_count - 1 - cursor->sorted_pos : cursor->sorted_pos;
+            cursor->sorted_pos++;
+            if (!rs_readAt(&bank_store, cursor->data, cursor->sorted[pos].slot, &rec)) continue;
+        }
+        if (bank_matchesFilter(cursor, &rec) && bank_decodeAccount(&cursor->header, cursor->holders, &rec, acc)) return true;
+    }
+}
+
+void bank_closeListing(struct ListingCursor *cursor) {
+    if (cursor->data != NULL) fclose(cursor->data);
+    if (cursor->holders != NULL) fclose(cursor->holders);
+    if (cursor->idx != NULL) fclose(cursor->idx);
+    free(cursor->chunk);
+    free(cursor->sorted);
+    memset(cursor, 0, sizeof(struct ListingCursor));
+}
+
+// --- Index Helper Functions Implementation ---
+static int bank_compareIndexEntries(const void *a, const void *b) {
+    long lhs = ((const struct AccountIndexEntry *)a)->account_number;
+    long rhs = ((const struct AccountIndexEntry *)b)->account_number;
+    return (lhs > rhs) - (lhs < rhs);
+}
+
+static int bank_compareNameEntries(const void *a, const void *b) {
+    const struct NameIndexEntry *lhs = (const struct NameIndexEntry *)a;
+    const struct NameIndexEntry *rhs = (const struct NameIndexEntry *)b;
+    int by_name = strncmp(lhs->folded_name, rhs->folded_name, BANK_MAX_NAME_LENGTH);
+    if (by_name != 0) return by_name;
+    return (lhs->account_number > rhs->account_number) - (lhs->account_number < rhs->account_number);
+}
+
+// Rebuilds the indexes if they are missing or do not cover every record,
+// e.g. for a data file written before an index existed. Every slot is either
+// indexed or on the free list, so the counts alone reveal a mismatch.
+void bank_ensureIndex() {
+    long record_count = 0, entry_count = -1;
+    FILE *fp = fopen(BANK_FILENAME, "rb");
+    if (fp != NULL) {
+        record_count = rs_countSlots(&bank_store, fp);
+        fclose(fp);
+    }
+    FILE *idx = fopen(BANK_INDEX_FILENAME, "rb");
+    if (idx != NULL) {
+        entry_count = rs_countRecords(idx, sizeof(struct AccountIndexEntry));
+        fclose(idx);
+    }
+    if (entry_count < 0 || entry_count + bank_countFreeSlots() != record_count) {
+        bank_rebuildIndex();
+        idx = fopen(BANK_INDEX_FILENAME, "rb");
+        entry_count = idx != NULL ? rs_countRecords(idx, sizeof(struct AccountIndexEntry)) : 0;
+        if (idx != NULL) fclose(idx);
+    }
+
+    long live_count = entry_count, name_count = -1;
+    idx = fopen(BANK_NAME_INDEX_FILENAME, "rb");
+    if (idx != NULL) {
+        name_count = rs_countRecords(idx, sizeof(struct NameIndexEntry));
+        fclose(idx);
+    }
+    if (name_count != live_count) bank_rebuildNameIndex();
+}
+
+// Builds the index and the free list from a sequential pass over the data file;
+// only the 16-byte index entries are held in memory, never the accounts themselves.
+void bank_rebuildIndex() {
+    struct AccountIndexEntry *entries = NULL;
+    long count = 0, capacity = 0, slot = 0;
+    struct BankFileHeader header;
+    FILE *fp = fopen(BANK_FILENAME, "rb");
+    FILE *free_list = fopen(BANK_FREE_FILENAME, "wb");
+    if (free_list == NULL) perror("Error opening file for saving free list");
+    struct StoredAccount *chunk = (struct StoredAccount *)malloc(BANK_IO_CHUNK * sizeof(struct StoredAccount));
+    if (fp != NULL && chunk != NULL && bank_readHeader(fp, &header)) {
+        size_t n;
+        while ((n = fread(chunk, sizeof(struct StoredAccount), BANK_IO_CHUNK, fp)) > 0) {
+            if (count + (long)n > capacity) {
+                capacity = (capacity + (long)n) * 2;
+                struct AccountIndexEntry *grown = (struct AccountIndexEntry *)realloc(entries, capacity * sizeof(struct AccountIndexEntry));
+                if (grown == NULL) {
+                    printf("Error: Not enough memory to build the account index.\n");
+                    break;
+                }
+                entries = grown;
+            }
+            for (size_t i = 0; i < n; i++, slot++) {
+                if (chunk[i].account_number == BANK_TOMBSTONE) {
+                    if (free_list != NULL) fwrite(&slot, sizeof(long), 1, free_list);
+                    continue;
+                }
+                entries[count].account_number = (long)chunk[i].account_number;
+                entries[count].slot = slot;
+                count++;
+            }
+        }
+    }
+    if (fp != NULL) fclose(fp);
+    if (free_list != NULL) fclose(free_list);
+    free(chunk);
+    if (count > 0) {
+        qsort(entries, count, sizeof(struct AccountIndexEntry), bank_compareIndexEntries);
+    }
+
+    FILE *idx = fopen(BANK_INDEX_FILENAME, "wb");
+    if (idx == NULL) {
+        perror("Error opening file for saving account index");
+    } else {
+        fwrite(entries, sizeof(struct AccountIndexEntry), count, idx);
+        fclose(idx);
+    }
+    free(entries);
+}
+
+// Same as bank_rebuildIndex, for the holder-name index; names are read from the holders file.
+void bank_rebuildNameIndex() {
+    struct NameIndexEntry *entries = NULL;
+    long count = 0, capacity = 0;
+    struct BankFileHeader header;
+    struct Account acc;
+    FILE *fp = fopen(BANK_FILENAME, "rb");
+    struct StoredAccount *chunk = (struct StoredAccount *)malloc(BANK_IO_CHUNK * sizeof(struct StoredAccount));
+    if (fp != NULL && chunk != NULL && bank_readHeader(fp, &header)) {
+        FILE *holders = bank_holdersFile(&header);
+        size_t n;
+        while ((n = fread(chunk, sizeof(struct StoredAccount), BANK_IO_CHUNK, fp)) > 0) {
+            if (count + (long)n > capacity) {
+                capacity = (capacity + (long)n) * 2;
+                struct NameIndexEntry *grown = (struct NameIndexEntry *)realloc(entries, capacity * sizeof(struct NameIndexEntry));
+                if (grown == NULL) {
+                    printf("Error: Not enough memory to build the name index.\n");
+                    break;
+                }
+                entries = grown;
+            }
+            for (size_t i = 0; i < n; i++) {
+                if (chunk[i].account_number == BANK_TOMBSTONE || !bank_decodeAccount(&header, holders, &chunk[i], &acc)) continue;
+                memset(&entries[count], 0, sizeof(struct NameIndexEntry));
+                bank_foldName(acc.account_holder_name, entries[count].folded_name);
+                entries[count].account_number = acc.account_number;
+                count++;
+            }
+        }
+    }
+    if (fp != NULL) fclose(fp);
+    free(chunk);
+    if (count > 0) {
+        qsort(entries, count, sizeof(struct NameIndexEntry), bank_compareNameEntries);
+    }
+
+    FILE *idx = fopen(BANK_NAME_INDEX_FILENAME, "wb");
+    if (idx == NULL) {
+        perror("Error opening file for saving name index");
+    } else {
+        fwrite(entries, sizeof(struct NameIndexEntry), count, idx);
+        fclose(idx);
+    }
+    free(entries);
+}
+
+// Returns the record slot of the account, or -1 if it does not exist.
+long bank_findAccountSlot(long account_number) {
+    FILE *idx = fopen(BANK_INDEX_FILENAME, "rb");
+    if (idx == NULL) return -1;
+
+    long slot = -1;
+    long entry_count = rs_countRecords(idx, sizeof(struct AccountIndexEntry));
+    struct AccountIndexEntry entry = { account_number, 0 };
+    long pos = rs_sortedLowerBound(idx, &entry, sizeof(struct AccountIndexEntry), entry_count, bank_compareIndexEntries);
+    if (pos < entry_count && fseek(idx, pos * (long)sizeof(struct AccountIndexEntry), SEEK_SET) == 0 &&
+        fread(&entry, sizeof(struct AccountIndexEntry), 1, idx) == 1 && entry.account_number == account_number) {
+        slot = entry.slot;
+    }
+    fclose(idx);
+    return slot;
+}
+
+void bank_indexInsert(long account_number, long slot) {
+    struct AccountIndexEntry entry = { account_number, slot };
+    rs_sortedInsert(BANK_INDEX_FILENAME, &entry, sizeof(struct AccountIndexEntry), bank_compareIndexEntries);
+}
+
+// Lower-cases a holder name into a zero-padded key, so name search ignores case.
+void bank_foldName(const char *name, char folded[BANK_MAX_NAME_LENGTH]) {
+    memset(folded, 0, BANK_MAX_NAME_LENGTH);
+    for (int i = 0; i < BANK_MAX_NAME_LENGTH - 1 && name[i] != '\0'; i++) {
+        folded[i] = (char)tolower((unsigned char)name[i]);
+    }
+}
+
+// Collects the numbers of accounts whose holder name starts with prefix (case-insensitive;
+// a full name matches itself) in name order. Returns how many matched, which may exceed
+// max_results; only the first max_results are stored.
+long bank_findByName(const char *prefix, long account_numbers[], long max_results) {
+    FILE *idx = fopen(BANK_NAME_INDEX_FILENAME, "rb");
+    if (idx == NULL) return 0;
+
+    struct NameIndexEntry probe;
+    memset(&probe, 0, sizeof(probe));
+    bank_foldName(prefix, probe.folded_name); // account_number 0 sorts before every real account
+    size_t prefix_length = strlen(probe.folded_name);
+    long entry_count = rs_countRecords(idx, sizeof(struct NameIndexEntry));
+    long pos = rs_sortedLowerBound(idx, &probe, sizeof(struct NameIndexEntry), entry_count, bank_compareNameEntries);
+
+    long matches = 0;
+    struct NameIndexEntry entry;
+    fseek(idx, pos * (long)sizeof(struct NameIndexEntry), SEEK_SET);
+    while (fread(&entry, sizeof(struct NameIndexEntry), 1, idx) == 1 &&
+           strncmp(entry.folded_name, probe.folded_name, prefix_length) == 0) {
+        if (matches < max_results) account_numbers[matches] = entry.account_number;
+        matches++;
+    }
+    fclose(idx);
+    return matches;
+}
+
+void bank_indexRemove(long account_number) {
+    struct AccountIndexEntry entry = { account_number, 0 };
+    rs_sortedRemove(BANK_INDEX_FILENAME, &entry, sizeof(struct AccountIndexEntry), bank_compareIndexEntries);
+}
+
+// --- Free List and Compaction Implementation ---
+// Deleted records stay in place as tombstones and their slots are kept on a
+// stack in BANK_FREE_FILENAME, so a delete is one record write instead of a
+// rewrite of the file. Compaction squeezes the tombstones out once they pile up.
+long bank_countFreeSlots() {
+    FILE *fp = fopen(BANK_FREE_FILENAME, "rb");
+    if (fp == NULL) return 0;
+    long count = rs_countRecords(fp, sizeof(long));
+    fclose(fp);
+    return count;
+}
+
+void bank_pushFreeSlot(long slot) {
+    FILE *fp = fopen(BANK_FREE_FILENAME, "ab");
+    if (fp == NULL || fwrite(&slot, sizeof(long), 1, fp) != 1) {
+        perror("Error saving free list");
+    }
+    if (fp != NULL) fclose(fp);
+}
+
+// Returns the most recently freed slot without taking it; -1 if there is none.
+long bank_peekFreeSlot() {
+    FILE *fp = fopen(BANK_FREE_FILENAME, "rb");
+    if (fp == NULL) return -1;
+    long slot = -1;
+    long count = rs_countRecords(fp, sizeof(long));
+    if (count == 0 || fseek(fp, (count - 1) * (long)sizeof(long), SEEK_SET) != 0 ||
+        fread(&slot, sizeof(long), 1, fp) != 1) {
+        slot = -1;
+    }
+    fclose(fp);
+    return slot;
+}
+
+void bank_popFreeSlot() {
+    FILE *fp = fopen(BANK_FREE_FILENAME, "r+b");
+    if (fp == NULL) return;
+    long count = rs_countRecords(fp, sizeof(long));
+    if (count > 0) rs_truncateFile(fp, (count - 1) * (long)sizeof(long));
+    fclose(fp);
+}
+
+/*
+ * Copies the live records to a new data file, a chunk at a time, and their
+ * holder names to the next generation's holders file, then renames the data file
+ * into place; that rename switches both at once. The account index is then
+ * rebuilt (slots moved) and the free list emptied. The name index is keyed by
+ * account number and does not change. A crash part-way leaves counts that
+ * bank_ensureIndex notices and repairs. The caller holds the table lock
+ * exclusively with nothing pending in the journal.
+ * Returns the number of slots reclaimed, or -1 on error.
+ */
+long bank_compact() {
+    struct BankFileHeader header, next;
+    FILE *in = fopen(BANK_FILENAME, "rb");
+    if (in == NULL) return 0;
+    if (!bank_readHeader(in, &header)) {
+        fclose(in);
+        return -1;
+    }
+    FILE *old_holders = bank_holdersFile(&header);
+    next = header;
+    next.holders_generation++;
+    char old_path[64], new_path[64];
+    bank_holdersPath(old_path, sizeof(old_path), header.holders_generation);
+    bank_holdersPath(new_path, sizeof(new_path), next.holders_generation);
+    FILE *holders = fopen(new_path, "w+b");
+    FILE *out = fopen(BANK_TEMP_FILENAME, "wb");
+    struct StoredAccount *chunk = (struct StoredAccount *)malloc(BANK_IO_CHUNK * sizeof(struct StoredAccount));
+    if (holders == NULL || out == NULL || chunk == NULL) {
+        perror("Error opening file for compacting accounts");
+        fclose(in);
+        if (holders != NULL) fclose(holders);
+        if (out != NULL) fclose(out);
+        free(chunk);
+        return -1;
+    }
+
+    bool ok = bank_writeHeader(out, &next);
+    long reclaimed = 0;
+    size_t n;
+    struct Account acc;
+    while (ok && (n = fread(chunk, sizeof(struct StoredAccount), BANK_IO_CHUNK, in)) > 0) {
+        size_t kept = 0;
+        for (size_t i = 0; i < n && ok; i++) {
+            if (chunk[i].account_number == BANK_TOMBSTONE) continue;
+            ok = bank_decodeAccount(&header, old_holders, &chunk[i], &acc) &&
+                 bank_encodeAccount(&next, holders, &acc, &chunk[kept]);
+            kept++;
+        }
+        reclaimed += (long)(n - kept);
+        ok = ok && fwrite(chunk, sizeof(struct StoredAccount), kept, out) == kept;
+    }
+    free(chunk);
+    fclose(in);
+    rs_syncFile(holders);
+    fclose(holders);
+    rs_syncFile(out);
+    fclose(out);
+    if (!ok || !rs_replaceFile(BANK_TEMP_FILENAME, BANK_FILENAME)) {
+        perror("Error compacting accounts");
+        remove(BANK_TEMP_FILENAME);
+        remove(new_path);
+        return -1;
+    }
+    bank_holdersFile(&next); // Closes the old generation so it can be removed
+    remove(old_path);
+    bank_rebuildIndex(); // Also writes an empty free list
+    return reclaimed;
+}
+
+// --- Locking Helper Functions Implementation ---
+// POSIX record locks (fcntl) are held per process and let instances update
+// different accounts in parallel. On Windows locking is not implemented, so
+// only one instance should run against the same files there.
+static int bank_lock_fd = -1;
+static struct JournalRecord bank_pending[BANK_GROUP_COMMIT_SIZE]; // Logged but not yet committed
+static int bank_pending_count = 0;
+static int bank_table_lock = BANK_LOCK_NONE; // Mode currently held by this process
+
+void bank_openLockFile() {
+    #ifndef _WIN32
+        bank_lock_fd = open(BANK_LOCK_FILENAME, O_RDWR | O_CREAT, 0644);
+        if (bank_lock_fd < 0) {
+            perror("Error opening lock file");
+        }
+    #endif
+}
+
+// Returns false if the lock could not be taken: busy (when not waiting), or
+// refused by the kernel because waiting would deadlock with another instance.
+bool bank_lockRange(long offset, long length, int mode, bool wait) {
+    #ifdef _WIN32
+        (void)offset; (void)length; (void)mode; (void)wait;
+        return true;
+    #else
+        if (bank_lock_fd < 0) return true;
+        struct flock fl;
+        memset(&fl, 0, sizeof(fl));
+        fl.l_type = mode == BANK_LOCK_EXCLUSIVE ? F_WRLCK : mode == BANK_LOCK_SHARED ? F_RDLCK : F_UNLCK;
+        fl.l_whence = SEEK_SET;
+        fl.l_start = offset;
+        fl.l_len = length;
+        while (fcntl(bank_lock_fd, wait ? F_SETLKW : F_SETLK, &fl) != 0) {
+            if (errno != EINTR) return false;
+        }
+        return true;
+    #endif
+}
+
+static long bank_stripeOf(long account_number) {
+    return (account_number % BANK_LOCK_STRIPES + BANK_LOCK_STRIPES) % BANK_LOCK_STRIPES;
+}
+
+// Takes the locks a change needs and keeps them until the next commit. Stripes
+// are taken in ascending order; if the kernel still reports a deadlock (another
+// instance holds locks for its own pending group), everything is released (by
+// committing what is pending) and the attempt starts over.
+bool bank_beginChange(bool structural, const long account_numbers[], int count) {
+    int table_mode = structural ? BANK_LOCK_EXCLUSIVE : BANK_LOCK_SHARED;
+    long stripes[BANK_MAX_CHANGE_RECORDS];
+    for (int i = 0; i < count; i++) {
+        long stripe = bank_stripeOf(account_numbers[i]);
+        int j = i;
+        for (; j > 0 && stripes[j - 1] > stripe; j--) stripes[j] = stripes[j - 1];
+        stripes[j] = stripe;
+    }
+
+    while (true) {
+        bool locked = true;
+        if (bank_table_lock < table_mode) {
+            locked = bank_lockRange(BANK_LOCK_TABLE, 1, table_mode, true);
+            if (locked) bank_table_lock = table_mode;
+        }
+        for (int i = 0; locked && bank_table_lock != BANK_LOCK_EXCLUSIVE && i < count; i++) {
+            locked = bank_lockRange(BANK_LOCK_FIRST_STRIPE + stripes[i], 1, BANK_LOCK_EXCLUSIVE, true);
+        }
+        if (locked) return true;
+        if (errno != EDEADLK) {
+            perror("Error locking accounts");
+            bank_rejectChange(0);
+            return false;
+        }
+        bank_commitTransactions(); // Also releases the locks when nothing is pending
+    }
+}
+
+void bank_releaseLocks() {
+    bank_lockRange(0, 0, BANK_LOCK_NONE, false); // Length 0 covers the whole file
+    bank_table_lock = BANK_LOCK_NONE;
+}
+
+// Ends a change that was not logged; its locks go unless earlier changes still need them.
+int bank_rejectChange(int status) {
+    if (bank_pending_count == 0) bank_releaseLocks();
+    return status;
+}
+
+// --- Existence Filter Implementation ---
+// A Bloom filter over every account number, built from one sequential read of
+// the index the first time it is needed. Creating an account with a new number
+// (the usual case) then costs no index search for the duplicate check. Numbers
+// of deleted accounts stay in the filter and just fall through to the index.
+// Other instances count their creates in the first bytes of the lock file; when
+// that count moves, the filter is rebuilt, so it never misses an account.
+static unsigned char *bank_filter = NULL;
+static unsigned long bank_filter_bits = 0; // Power of two
+static long bank_filter_keys = 0;
+static long long bank_filter_version = -1; // Create count the filter reflects
+
+static unsigned long long bank_mixKey(long account_number) {
+    unsigned long long x = (unsigned long long)account_number + 0x9E3779B97F4A7C15ull; // splitmix64
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+void bank_filterAdd(long account_number) {
+    if (bank_filter == NULL) return;
+    unsigned long long hash = bank_mixKey(account_number);
+    unsigned long step = (unsigned long)(hash >> 32) | 1;
+    for (int i = 0; i < 4; i++) {
+        unsigned long bit = ((unsigned long)hash + i * step) & (bank_filter_bits - 1);
+        bank_filter[bit / 8] |= (unsigned char)(1u << (bit % 8));
+    }
+    bank_filter_keys++;
+}
+
+bool bank_filterMayContain(long account_number) {
+    unsigned long long hash = bank_mixKey(account_number);
+    unsigned long step = (unsigned long)(hash >> 32) | 1;
+    for (int i = 0; i < 4; i++) {
+        unsigned long bit = ((unsigned long)hash + i * step) & (bank_filter_bits - 1);
+        if (!(bank_filter[bit / 8] & (1u << (bit % 8)))) return false;
+    }
+    return true;
+}
+
+// Sizes the filter for the index (with room to grow) and loads every account number into it.
+void bank_rebuildFilter(long long version) {
+    FILE *idx = fopen(BANK_INDEX_FILENAME, "rb");
+    long entry_count = idx != NULL ? rs_countRecords(idx, sizeof(struct AccountIndexEntry)) : 0;
+    unsigned long bits = BANK_BLOOM_MIN_BITS;
+    while (bits < (unsigned long)(entry_count + BANK_IO_CHUNK) * 2 * BANK_BLOOM_BITS_PER_KEY) bits *= 2;
+    free(bank_filter);
+    bank_filter = (unsigned char *)calloc(bits / 8, 1);
+    bank_filter_bits = bits;
+    bank_filter_keys = 0;
+    bank_filter_version = -1;
+    struct AccountIndexEntry *chunk = (struct AccountIndexEntry *)malloc(BANK_IO_CHUNK * sizeof(struct AccountIndexEntry));
+    if (bank_filter != NULL && chunk != NULL) {
+        if (idx != NULL) fseek(idx, 0, SEEK_SET);
+        size_t n;
+        while (idx != NULL && (n = fread(chunk, sizeof(struct AccountIndexEntry), BANK_IO_CHUNK, idx)) > 0) {
+            for (size_t i = 0; i < n; i++) bank_filterAdd(chunk[i].account_number);
+        }
+        for (int i = 0; i < bank_pending_count; i++) {
+            if (bank_pending[i].op == BANK_OP_CREATE) bank_filterAdd(bank_pending[i].account.account_number);
+        }
+        bank_filter_version = version;
+    }
+    if (idx != NULL) fclose(idx);
+    free(chunk);
+}
+
+// Number of accounts ever created by any instance; 0 where there is no lock file.
+long long bank_readCreateCount() {
+    long long count = 0;
+    #ifndef _WIN32
+        if (bank_lock_fd >= 0 && pread(bank_lock_fd, &count, sizeof(count), 0) != (ssize_t)sizeof(count)) count = 0;
+    #endif
+    return count;
+}
+
+// Records a create; the caller holds the table lock exclusively.
+void bank_countCreate() {
+    long long count = bank_readCreateCount() + 1;
+    #ifndef _WIN32
+        if (bank_lock_fd >= 0 && pwrite(bank_lock_fd, &count, sizeof(count), 0) != (ssize_t)sizeof(count)) {
+            perror("Error updating lock file");
+        }
+    #endif
+    if (bank_filter_version == count - 1) {
+        bank_filter_version = count; // Our own create: the caller adds it to the filter
+    }
+}
+
+// Whether an account number is in use (including by changes not yet committed).
+bool bank_accountExists(long account_number) {
+    long long version = bank_readCreateCount();
+    if (bank_filter == NULL || version != bank_filter_version ||
+        bank_filter_keys * 2 * BANK_BLOOM_BITS_PER_KEY > (long)bank_filter_bits) { // Refill before it gets crowded
+        bank_rebuildFilter(version);
+    }
+    if (bank_filter != NULL && !bank_filterMayContain(account_number)) return false;
+    struct Account acc;
+    return bank_lookupAccount(account_number, &acc);
+}
+
+// --- Journal Helper Functions Implementation ---
+static FILE *bank_journal = NULL;
+static long bank_applied_since_checkpoint = 0;
+static unsigned long long bank_writer_id = 0; // Tags this session's journal records
+static bool bank_apply_failed = false; // A record could not be applied; the next checkpoint replays everything
+
+// Returns an id for this process's journal records that no other session shares.
+static unsigned long long bank_newWriterId() {
+    struct timespec now;
+    timespec_get(&now, TIME_UTC);
+    #ifdef _WIN32
+        unsigned long long pid = GetCurrentProcessId();
+    #else
+        unsigned long long pid = (unsigned long long)getpid();
+    #endif
+    return ((unsigned long long)now.tv_sec << 32) ^ (unsigned long long)now.tv_nsec ^ (pid << 40) ^ pid;
+}
+
+static unsigned int bank_journalChecksum(const struct JournalRecord *rec) {
+    struct JournalRecord copy = *rec;
+    copy.checksum = 0;
+    return bank_checksum(&copy, sizeof(copy));
+}
+
+// Recovers whatever a previous or crashed session left in the journal.
+void bank_openJournal() {
+    bank_writer_id = bank_newWriterId();
+    bank_journal = fopen(BANK_JOURNAL_FILENAME, "ab"); // Append mode: shared safely with other instances
+    if (bank_journal == NULL) {
+        perror("Error opening transaction journal");
+    }
+    bank_lockRange(BANK_LOCK_TABLE, 1, BANK_LOCK_EXCLUSIVE, true);
+    bank_table_lock = BANK_LOCK_EXCLUSIVE;
+    bank_ensureIndex();
+    long replayed = bank_checkpoint(); // Replays what earlier sessions left, then empties the journal
+    if (replayed > 0) {
+        printf("Recovered %ld journaled transaction(s) from the previous session.\n", replayed);
+    }
+    bank_releaseLocks();
+}
+
+void bank_closeJournal() {
+    bank_commitTransactions();
+    bank_lockRange(BANK_LOCK_TABLE, 1, BANK_LOCK_EXCLUSIVE, true);
+    bank_table_lock = BANK_LOCK_EXCLUSIVE;
+    bank_checkpoint();
+    bank_releaseLocks();
+    if (bank_journal != NULL) {
+        fclose(bank_journal);
+        bank_journal = NULL;
+    }
+}
+
+// Returns the latest state of an account, including changes logged but not yet committed.
+bool bank_lookupAccount(long account_number, struct Account *acc) {
+    for (int i = bank_pending_count - 1; i >= 0; i--) {
+        if (bank_pending[i].account.account_number == account_number) {
+            if (bank_pending[i].op == BANK_OP_DELETE) return false;
+            *acc = bank_pending[i].account;
+            return true;
+        }
+    }
+
+    long slot = bank_findAccountSlot(account_number);
+    if (slot < 0) return false;
+    FILE *fp = fopen(BANK_FILENAME, "rb");
+    if (fp == NULL) return false;
+    bool found = bank_readAccountAt(fp, slot, acc);
+    fclose(fp);
+    return found;
+}
+
+// Appends a change to the journal. The caller must hold the locks from
+// bank_beginChange. The change becomes durable and is applied to the data file at
+// the next commit, which happens automatically once a full group is pending.
+bool bank_logTransaction(int op, const struct Account *acc) {
+    return bank_logTransactionGroup(&op, acc, 1);
+}
+
+// Logs records that must be applied all together or not at all. They go out in a
+// single write as one group, so replay can drop a group whose tail never reached
+// the disk.
+bool bank_logTransactionGroup(const int ops[], const struct Account accs[], int count) {
+    if (bank_journal == NULL) {
+        printf("Error: The transaction journal is not open.\n");
+        return false;
+    }
+    struct JournalRecord *recs = &bank_pending[bank_pending_count];
+    memset(recs, 0, count * sizeof(struct JournalRecord)); // No stray stack bytes in the padding written to disk
+    for (int i = 0; i < count; i++) {
+        recs[i].op = ops[i];
+        recs[i].group_size = count;
+        recs[i].writer = bank_writer_id;
+        recs[i].account = accs[i];
+    }
+
+    // Other instances append to the same journal, so the position (and with it the
+    // sequence number) is only known while holding the journal lock.
+    bank_lockRange(BANK_LOCK_JOURNAL, 1, BANK_LOCK_EXCLUSIVE, true);
+    long size = (fseek(bank_journal, 0, SEEK_END) == 0) ? ftell(bank_journal) : 0;
+    if (size % (long)sizeof(struct JournalRecord) != 0) {
+        size -= size % (long)sizeof(struct JournalRecord); // Drop a torn record left by a crashed instance
+        rs_truncateFile(bank_journal, size);
+    }
+    for (int i = 0; i < count; i++) {
+        recs[i].sequence = size / (long)sizeof(struct JournalRecord) + 1 + i;
+        recs[i].group = recs[0].sequence;
+        recs[i].checksum = bank_journalChecksum(&recs[i]);
+    }
+    bool ok = fwrite(recs, sizeof(struct JournalRecord), count, bank_journal) == (size_t)count && fflush(bank_journal) == 0;
+    bank_lockRange(BANK_LOCK_JOURNAL, 1, BANK_LOCK_NONE, false);
+    if (!ok) {
+        perror("Error writing transaction journal");
+        return false;
+    }
+    bank_pending_count += count;
+    if (bank_pending_count + BANK_MAX_CHANGE_RECORDS > BANK_GROUP_COMMIT_SIZE) {
+        bank_commitTransactions(); // No room left for another change
+    }
+    return true;
+}
+
+// Group commit: one fsync makes every pending record durable, then they are
+// applied and the locks taken for them are released.
+void bank_commitTransactions() {
+    if (bank_pending_count > 0) {
+        rs_syncFile(bank_journal);
+        for (int i = 0; i < bank_pending_count; i++) {
+            bank_applyTransaction(bank_pending[i].op, &bank_pending[i].account);
+        }
+        bank_applied_since_checkpoint += bank_pending_count;
+        bank_pending_count = 0;
+    }
+    // Checkpoint only if no other instance is mid-transaction right now; otherwise try again later.
+    if (bank_applied_since_checkpoint >= BANK_CHECKPOINT_INTERVAL &&
+        bank_lockRange(BANK_LOCK_TABLE, 1, BANK_LOCK_EXCLUSIVE, false)) {
+        bank_table_lock = BANK_LOCK_EXCLUSIVE;
+        bank_checkpoint();
+    }
+    bank_releaseLocks();
+}
+
+// Re-applies every complete group of intact journal records in order; the caller
+// holds the table lock exclusively. With skip_own, groups this session logged are
+// left out: it applied them itself when it committed them.
+long bank_replayJournal(bool skip_own) {
+    FILE *fp = fopen(BANK_JOURNAL_FILENAME, "rb");
+    if (fp == NULL) return 0;
+    struct JournalRecord group[BANK_MAX_CHANGE_RECORDS], rec;
+    int grouped = 0;
+    long read = 0, replayed = 0;
+    while (fread(&rec, sizeof(struct JournalRecord), 1, fp) == 1) {
+        // Stop at a torn or partially written tail: those records were never committed.
+        if (rec.checksum != bank_journalChecksum(&rec) || rec.sequence != read + 1) break;
+        read++;
+        if (grouped > 0 && rec.group != group[0].group) grouped = 0; // Drop a group its crashed writer never finished
+        if (rec.group_size < 1 || rec.group_size > BANK_MAX_CHANGE_RECORDS || rec.sequence != rec.group + grouped) {
+            continue; // The rest of a group whose start was dropped
+        }
+        group[grouped++] = rec;
+        if (grouped < rec.group_size) continue;
+        if (!skip_own || rec.writer != bank_writer_id) {
+            for (int i = 0; i < grouped; i++) {
+                bank_applyTransaction(group[i].op, &group[i].account);
+            }
+            replayed += grouped;
+        }
+        grouped = 0;
+    }
+    fclose(fp);
+    return replayed;
+}
+
+// Makes the data and index files durable, after which the journal is emptied, so
+// the next replay covers only records logged since. The caller holds the table
+// lock exclusively, so every other live instance has applied what it logged;
+// records from other sessions are replayed first in case their writer crashed
+// before applying them. This session's own records are skipped unless one of
+// them failed to apply. Returns the number of records replayed.
+long bank_checkpoint() {
+    if (bank_journal == NULL) return 0;
+    long replayed = bank_replayJournal(!bank_apply_failed);
+    struct BankFileHeader header;
+    char holders_path[64] = "";
+    FILE *data = fopen(BANK_FILENAME, "rb");
+    if (data != NULL && bank_readHeader(data, &header)) {
+        bank_holdersPath(holders_path, sizeof(holders_path), header.holders_generation);
+    }
+    if (data != NULL) fclose(data);
+    const char *filenames[] = { holders_path, BANK_FILENAME, BANK_INDEX_FILENAME, BANK_NAME_INDEX_FILENAME, BANK_FREE_FILENAME };
+    for (size_t i = 0; i < sizeof(filenames) / sizeof(filenames[0]); i++) {
+        FILE *fp = fopen(filenames[i], "r+b");
+        if (fp != NULL) {
+            rs_syncFile(fp);
+            fclose(fp);
+        }
+    }
+    bank_lockRange(BANK_LOCK_JOURNAL, 1, BANK_LOCK_EXCLUSIVE, true);
+    rs_truncateFile(bank_journal, 0);
+    bank_lockRange(BANK_LOCK_JOURNAL, 1, BANK_LOCK_NONE, false);
+    bank_applied_since_checkpoint = 0;
+    bank_apply_failed = false;
+
+    // Background compaction: piggybacks on the exclusive lock the checkpoint already holds.
+    long free_slots = bank_countFreeSlots();
+    if (free_slots >= BANK_COMPACT_MIN_FREE) {
+        FILE *fp = fopen(BANK_FILENAME, "rb");
+        long record_count = fp != NULL ? rs_countSlots(&bank_store, fp) : 0;
+        if (fp != NULL) fclose(fp);
+        if (free_slots * BANK_COMPACT_RATIO > record_count) bank_compact();
+    }
+    return replayed;
+}
+
+// Applies one journal record to the data file. Safe to repeat for a record
+// that was already applied before a crash.
+void bank_applyTransaction(int op, const struct Account *acc) {
+    long slot = bank_findAccountSlot(acc->account_number);
+    if (op == BANK_OP_CREATE) {
+        if (slot >= 0) return;
+        // Reuse a tombstoned slot if there is one. The record is written before the
+        // slot leaves the free list, so a crash in between just repeats the write.
+        long new_slot = bank_peekFreeSlot();
+        bool reused = new_slot >= 0;
+        FILE *fp = fopen(BANK_FILENAME, "r+b");
+        if (fp == NULL) {
+            perror("Error opening file for saving accounts");
+            bank_apply_failed = true;
+            return;
+        }
+        if (!reused) new_slot = rs_countSlots(&bank_store, fp);
+        bool ok = bank_writeAccountAt(fp, new_slot, acc);
+        fclose(fp);
+        if (!ok) {
+            perror("Error saving account");
+            bank_apply_failed = true;
+            return;
+        }
+        if (reused) bank_popFreeSlot();
+        bank_indexInsert(acc->account_number, new_slot);
+        struct NameIndexEntry name_entry;
+        memset(&name_entry, 0, sizeof(name_entry));
+        bank_foldName(acc->account_holder_name, name_entry.folded_name);
+        name_entry.account_number = acc->account_number;
+        rs_sortedInsert(BANK_NAME_INDEX_FILENAME, &name_entry, sizeof(struct NameIndexEntry), bank_compareNameEntries);
+    } else if (op == BANK_OP_UPDATE) {
+        if (slot < 0) return;
+        FILE *fp = fopen(BANK_FILENAME, "r+b");
+        if (fp == NULL || !bank_writeAccountAt(fp, slot, acc)) {
+            perror("Error saving account");
+            bank_apply_failed = true;
+        }
+        if (fp != NULL) fclose(fp);
+    } else if (op == BANK_OP_DELETE) {
+        if (slot < 0) return;
+        struct Account stored;
+        FILE *fp = fopen(BANK_FILENAME, "r+b");
+        bool have_stored = fp != NULL && bank_readAccountAt(fp, slot, &stored) &&
+                           stored.account_number == acc->account_number; // Name key as indexed
+        bool ok = fp != NULL && bank_writeTombstoneAt(fp, slot);
+        if (fp != NULL) fclose(fp);
+        if (!ok) {
+            perror("Error deleting account");
+            bank_apply_failed = true;
+        } else {
+            bank_pushFreeSlot(slot);
+            bank_indexRemove(acc->account_number);
+            struct NameIndexEntry name_entry;
+            memset(&name_entry, 0, sizeof(name_entry));
+            bank_foldName(have_stored ? stored.account_holder_name : acc->account_holder_name, name_entry.folded_name);
+            name_entry.account_number = acc->account_number;
+            rs_sortedRemove(BANK_NAME_INDEX_FILENAME, &name_entry, sizeof(struct NameIndexEntry), bank_compareNameEntries);
+        }
+    }
+}
+
+// --- Account Operations Implementation ---
+int bank_openAccount(const struct Account *acc) {
+    if (acc->account_number <= 0 || acc->balance < 0 ||
+        acc->account_holder_name[0] == '\0' || acc->account_type[0] == '\0') {
+        return BANK_STATUS_INVALID;
+    }
+    if (!bank_beginChange(true, &acc->account_number, 1)) return BANK_STATUS_IO_ERROR;
+    if (bank_accountExists(acc->account_number)) return bank_rejectChange(BANK_STATUS_EXISTS);
+    struct BankFileHeader header;
+    FILE *fp = fopen(BANK_FILENAME, "rb");
+    bool type_fits = fp != NULL && bank_readHeader(fp, &header) &&
+                     (header.type_count < BANK_MAX_ACCOUNT_TYPES || bank_findTypeCode(&header, acc->account_type) >= 0);
+    if (fp != NULL) fclose(fp);
+    if (!type_fits) return bank_rejectChange(BANK_STATUS_INVALID);
+    bank_countCreate(); // Before logging, which may commit and so release the table lock
+    bank_filterAdd(acc->account_number);
+    return bank_logTransaction(BANK_OP_CREATE, acc) ? BANK_STATUS_OK : bank_rejectChange(BANK_STATUS_IO_ERROR);
+}
+
+// On success acc holds the updated account; on insufficient funds, the unchanged one.
+int bank_adjustBalance(long account_number, long long amount, bool is_deposit, struct Account *acc) {
+    if (amount <= 0) return BANK_STATUS_INVALID;
+    if (!bank_beginChange(false, &account_number, 1)) return BANK_STATUS_IO_ERROR;
+    if (!bank_lookupAccount(account_number, acc)) return bank_rejectChange(BANK_STATUS_NOT_FOUND);
+
+    if (is_deposit) {
+        acc->balance += amount;
+    } else if (acc->balance >= amount) { // Withdraw
+        acc->balance -= amount;
+    } else {
+        return bank_rejectChange(BANK_STATUS_INSUFFICIENT_FUNDS);
+    }
+    return bank_logTransaction(BANK_OP_UPDATE, acc) ? BANK_STATUS_OK : bank_rejectChange(BANK_STATUS_IO_ERROR);
+}
+
+// Moves money between two accounts. Both after-images are journaled as one
+// group, so after a crash either both balances change or neither does.
+// from and to receive the updated accounts (unchanged on insufficient funds).
+int bank_transfer(long from_account, long to_account, long long amount, struct Account *from, struct Account *to) {
+    if (amount <= 0 || from_account == to_account) return BANK_STATUS_INVALID;
+    long accounts[2] = { from_account, to_account };
+    if (!bank_beginChange(false, accounts, 2)) return BANK_STATUS_IO_ERROR;
+    if (!bank_lookupAccount(from_account, from) || !bank_lookupAccount(to_account, to)) {
+        return bank_rejectChange(BANK_STATUS_NOT_FOUND);
+    }
+    if (from->balance < amount) return bank_rejectChange(BANK_STATUS_INSUFFICIENT_FUNDS);
+
+    from->balance -= amount;
+    to->balance += amount;
+    int ops[2] = { BANK_OP_UPDATE, BANK_OP_UPDATE };
+    struct Account accs[2] = { *from, *to };
+    return bank_logTransactionGroup(ops, accs, 2) ? BANK_STATUS_OK : bank_rejectChange(BANK_STATUS_IO_ERROR);
+}
+
+int bank_closeAccount(long account_number) {
+    struct Account acc;
+    if (!bank_beginChange(true, &account_number, 1)) return BANK_STATUS_IO_ERROR;
+    if (!bank_lookupAccount(account_number, &acc)) return bank_rejectChange(BANK_STATUS_NOT_FOUND);
+    return bank_logTransaction(BANK_OP_DELETE, &acc) ? BANK_STATUS_OK : bank_rejectChange(BANK_STATUS_IO_ERROR);
+}
+
+// Parses a non-negative amount with at most two decimals ("12", "12.5", "12.50") into cents.
+bool bank_parseMoney(const char *text, long long *cents) {
+    long long whole = 0, fraction = 0;
+    int digits = 0, decimals = 0;
+    while (*text == ' ') text++;
+    for (; *text >= '0' && *text <= '9'; text++, digits++) {
+        if (whole > (LLONG_MAX - 9) / 1000) return false; // Leave room for the cents
+        whole = whole * 10 + (*text - '0');
+    }
+    if (*text == '.') {
+        for (text++; *text >= '0' && *text <= '9'; text++, decimals++) {
+            if (decimals == 2) return false;
+            fraction = fraction * 10 + (*text - '0');
+        }
+    }
+    while (*text == ' ' || *text == '\n' || *text == '\r') text++;
+    if (*text != '\0' || digits + decimals == 0) return false;
+    *cents = whole * 100 + (decimals == 1 ? fraction * 10 : fraction);
+    return true;
+}
+
+// Prompts until a valid amount is entered; zero is accepted only when allow_zero is set.
+long long bank_readMoney(bool allow_zero) {
+    char line[BANK_MAX_LINE_LENGTH];
+    long long cents;
+    while (fgets(line, sizeof(line), stdin) != NULL) {
+        if (bank_parseMoney(line, &cents) && (allow_zero || cents > 0)) return cents;
+        printf("Invalid amount. Enter %s number with at most two decimals: ", allow_zero ? "0 or a positive" : "a positive");
+    }
+    return 0;
+}
+
+// Parses a signed percentage with at most two decimals ("1.25", "-0.5") into basis points.
+bool bank_parseRate(const char *text, long long *basis_points) {
+    while (*text == ' ') text++;
+    bool negative = *text == '-';
+    if (negative) text++;
+    if (!bank_parseMoney(text, basis_points) || *basis_points > 10000) return false; // At most 100%
+    if (negative) *basis_points = -*basis_points;
+    return true;
+}
+
+/*
+ * Computes balance * rate / 10000, rounded half away from zero, for a whole
+ * chunk of 32-bit balance and rate columns. The loop has a fixed trip count and
+ * works in double, whose 53-bit mantissa holds every product exactly, so it
+ * compiles to SIMD code (two or more lanes per instruction) even at -O2.
+ * With |balance| < 2^31 and |rate| <= 10000 the result matches the exact
+ * integer rounding: the product is below 2^45 and the quotient below 2^31, so
+ * rounding error stays far under the 1/10000 gap to the nearest half-cent tie.
+ */
+static void bank_rateDeltas(const int balances[BANK_IO_CHUNK], const int rates[BANK_IO_CHUNK], int deltas[BANK_IO_CHUNK]) {
+    for (int i = 0; i < BANK_IO_CHUNK; i++) {
+        double exact = (double)balances[i] * rates[i] / 10000.0;
+        deltas[i] = (int)(exact + (exact < 0 ? -0.5 : 0.5));
+    }
+}
+
+/*
+ * Applies a rate to every account whose type has a rule, in one sequential pass.
+ * Rules are resolved to type codes once, so each record costs a table lookup
+ * instead of string compares. Each chunk's balances and rates are copied into
+ * contiguous 32-bit columns and run through bank_rateDeltas, which vectorizes;
+ * the rare balance of 2^31 cents or more is done with 64-bit arithmetic
+ * instead. The result is written to a copy that replaces the data file, so a
+ * crash part-way leaves every balance untouched; record slots and holder names
+ * do not move, so the index stays valid. Runs with the table lock held
+ * exclusively after a checkpoint.
+ * Returns the number of accounts scanned, or -1 on error.
+ */
+long bank_applyRates(const struct RateRule rules[], int rule_count, long *changed) {
+    *changed = 0;
+    bank_commitTransactions();
+    bank_lockRange(BANK_LOCK_TABLE, 1, BANK_LOCK_EXCLUSIVE, true);
+    bank_table_lock = BANK_LOCK_EXCLUSIVE;
+    bank_checkpoint(); // The data file is current and the journal holds nothing left to replay
+
+    struct BankFileHeader header;
+    long long code_rates[BANK_MAX_ACCOUNT_TYPES + 1] = { 0 }; // By type code; the extra entry is for tombstones
+    bool code_ruled[BANK_MAX_ACCOUNT_TYPES + 1] = { false };
+    FILE *in = fopen(BANK_FILENAME, "rb");
+    FILE *out = in != NULL ? fopen(BANK_TEMP_FILENAME, "wb") : NULL;
+    struct StoredAccount *chunk = (struct StoredAccount *)malloc(BANK_IO_CHUNK * sizeof(struct StoredAccount));
+    int *balances = (int *)calloc(BANK_IO_CHUNK, sizeof(int)); // Zero past the end of a short last chunk
+    int *rates = (int *)calloc(BANK_IO_CHUNK, sizeof(int));
+    int *deltas = (int *)malloc(BANK_IO_CHUNK * sizeof(int));
+    long scanned = -1;
+    if (in == NULL || out == NULL || chunk == NULL || balances == NULL || rates == NULL || deltas == NULL ||
+        !bank_readHeader(in, &header) || !bank_writeHeader(out, &header)) {
+        if (in != NULL) perror("Error opening file for saving accounts");
+    } else {
+        for (int r = 0; r < rule_count; r++) {
+            int code = bank_findTypeCode(&header, rules[r].account_type);
+            if (code >= 0 && !code_ruled[code]) { // The first rule for a type wins
+                code_rates[code] = rules[r].basis_points;
+                code_ruled[code] = true;
+            }
+        }
+        bool ok = true;
+        size_t n;
+        scanned = 0;
+        while (ok && (n = fread(chunk, sizeof(struct StoredAccount), BANK_IO_CHUNK, in)) > 0) {
+            for (size_t i = 0; i < n; i++) {
+                int code = chunk[i].account_number == BANK_TOMBSTONE || chunk[i].type_code >= header.type_count
+                           ? BANK_MAX_ACCOUNT_TYPES : chunk[i].type_code;
+                bool fits = chunk[i].balance > INT_MIN && chunk[i].balance <= INT_MAX;
+                balances[i] = fits ? (int)chunk[i].balance : 0; // Larger balances are done below
+                rates[i] = (int)code_rates[code];
+                if (code != BANK_MAX_ACCOUNT_TYPES) scanned++;
+                if (code_ruled[code]) (*changed)++;
+            }
+            for (size_t i = n; i < BANK_IO_CHUNK; i++) balances[i] = rates[i] = 0;
+            bank_rateDeltas(balances, rates, deltas);
+            for (size_t i = 0; i < n; i++) {
+                long long delta = deltas[i];
+                if (balances[i] != chunk[i].balance) { // Beyond 32 bits: the same rounding, split so it cannot overflow
+                    long long whole = chunk[i].balance / 10000, part = chunk[i].balance % 10000 * rates[i];
+                    delta = whole * rates[i] + (part + (part < 0 ? -5000 : 5000)) / 10000;
+                }
+                if (delta == 0) continue;
+                chunk[i].balance += delta;
+                chunk[i].checksum = bank_checksum(&chunk[i], offsetof(struct StoredAccount, checksum));
+            }
+            ok = fwrite(chunk, sizeof(struct StoredAccount), n, out) == n;
+        }
+        rs_syncFile(out);
+        if (!ok) scanned = -1;
+    }
+    if (in != NULL) fclose(in);
+    if (out != NULL) fclose(out);
+    free(chunk);
+    free(balances);
+    free(rates);
+    free(deltas);
+
+    if (scanned >= 0 && !rs_replaceFile(BANK_TEMP_FILENAME, BANK_FILENAME)) {
+        perror("Error saving accounts");
+        scanned = -1;
+    }
+    if (scanned < 0) {
+        remove(BANK_TEMP_FILENAME);
+        *changed = 0;
+    }
+    bank_releaseLocks();
+    return scanned;
+}
+
+// --- Snapshot Report Implementation ---
+// Copies a file, as a copy-on-write clone where the filesystem supports it
+// (btrfs, XFS) and a chunked copy otherwise.
+bool bank_copyFile(const char *source, const char *dest) {
+    FILE *in = fopen(source, "rb");
+    if (in == NULL) return false;
+    FILE *out = fopen(dest, "wb");
+    if (out == NULL) {
+        fclose(in);
+        return false;
+    }
+    bool ok = false;
+    #ifdef FICLONE
+        ok = ioctl(fileno(out), FICLONE, fileno(in)) == 0;
+    #endif
+    if (!ok) {
+        char buffer[BANK_IO_CHUNK * 16];
+        size_t n;
+        ok = true;
+        while (ok && (n = fread(buffer, 1, sizeof(buffer), in)) > 0) {
+            ok = fwrite(buffer, 1, n, out) == n;
+        }
+    }
+    fclose(in);
+    if (fclose(out) != 0) ok = false;
+    if (!ok) remove(dest);
+    return ok;
+}
+
+/*
+ * Freezes the data file and its holder names as they stand into private copies
+ * for a report. The table lock is held exclusively only for the copies, so
+ * writers wait for one clone (or one sequential copy) instead of the whole
+ * report. Every change is applied before its locks are released, so the files
+ * are current while the lock is held. The caller removes both files when done.
+ */
+bool bank_takeSnapshot(char *path, char *holders_path, size_t path_size) {
+    #ifdef _WIN32
+        snprintf(path, path_size, "%s.%lu", BANK_SNAPSHOT_FILENAME, (unsigned long)GetCurrentProcessId());
+    #else
+        snprintf(path, path_size, "%s.%ld", BANK_SNAPSHOT_FILENAME, (long)getpid());
+    #endif
+    snprintf(holders_path, path_size, "%s.names", path);
+    bank_commitTransactions();
+    bank_lockRange(BANK_LOCK_TABLE, 1, BANK_LOCK_EXCLUSIVE, true);
+    bank_table_lock = BANK_LOCK_EXCLUSIVE;
+    struct BankFileHeader header;
+    char live_holders[64];
+    FILE *fp = fopen(BANK_FILENAME, "rb");
+    bool ok = fp != NULL && bank_readHeader(fp, &header);
+    if (fp != NULL) fclose(fp);
+    if (ok) {
+        bank_holdersPath(live_holders, sizeof(live_holders), header.holders_generation);
+        ok = bank_copyFile(BANK_FILENAME, path) && bank_copyFile(live_holders, holders_path);
+    }
+    bank_releaseLocks();
+    if (!ok) {
+        perror("Error taking snapshot of accounts");
+        remove(path);
+    }
+    return ok;
+}
+
+// Restores the min-heap order of top (smallest balance at top[0]) after top[pos] was replaced by rec.
+static void bank_siftDown(struct StoredAccount top[], int size, int pos, const struct StoredAccount *rec) {
+    while (true) {
+        int child = pos * 2 + 1;
+        if (child >= size) break;
+        if (child + 1 < size && top[child + 1].balance < top[child].balance) child++;
+        if (top[child].balance >= rec->balance) break;
+        top[pos] = top[child];
+        pos = child;
+    }
+    top[pos] = *rec;
+}
+
+// Totals balances by account type and lists the top_count largest balances, read
+// from a snapshot so deposits and withdrawals carry on while the report runs.
+// Only the 32-byte records are scanned; names are read for the top accounts alone.
+int bank_runReport(int top_count) {
+    if (top_count < 0) top_count = 0;
+    char path[64], holders_path[64];
+    if (!bank_takeSnapshot(path, holders_path, sizeof(path))) return 1;
+
+    struct timespec start, end;
+    timespec_get(&start, TIME_UTC);
+    struct BankFileHeader header;
+    FILE *fp = fopen(path, "rb");
+    FILE *holders = fopen(holders_path, "rb");
+    struct StoredAccount *chunk = (struct StoredAccount *)malloc(BANK_IO_CHUNK * sizeof(struct StoredAccount));
+    struct StoredAccount *top = (struct StoredAccount *)malloc((top_count > 0 ? top_count : 1) * sizeof(struct StoredAccount));
+    struct TypeTotal types[BANK_MAX_ACCOUNT_TYPES];
+    int top_size = 0;
+    long accounts = 0;
+    long long total = 0;
+    memset(types, 0, sizeof(types));
+    if (fp == NULL || holders == NULL || chunk == NULL || top == NULL || !bank_readHeader(fp, &header)) {
+        printf("Error: Could not read the snapshot.\n");
+        if (fp != NULL) fclose(fp);
+        if (holders != NULL) fclose(holders);
+        free(chunk);
+        free(top);
+        remove(path);
+        remove(holders_path);
+        return 1;
+    }
+
+    size_t n;
+    while ((n = fread(chunk, sizeof(struct StoredAccount), BANK_IO_CHUNK, fp)) > 0) {
+        for (size_t i = 0; i < n; i++) {
+            const struct StoredAccount *rec = &chunk[i];
+            if (rec->account_number == BANK_TOMBSTONE || rec->type_code >= header.type_count) continue;
+            accounts++;
+            total += rec->balance;
+            types[rec->type_code].count++;
+            types[rec->type_code].balance += rec->balance;
+
+            // top is a min-heap on balance: the smallest of the current top_count sits at top[0].
+            if (top_size < top_count) {
+                int pos = top_size++;
+                while (pos > 0 && top[(pos - 1) / 2].balance > rec->balance) {
+                    top[pos] = top[(pos - 1) / 2];
+                    pos = (pos - 1) / 2;
+                }
+                top[pos] = *rec;
+            } else if (top_count > 0 && rec->balance > top[0].balance) {
+                bank_siftDown(top, top_size, 0, rec);
+            }
+        }
+    }
+    fclose(fp);
+    free(chunk);
+    timespec_get(&end, TIME_UTC);
+
+    printf("--- Balance Report ---\n");
+    printf("%-20s %10s %20s\n", "Account Type", "Accounts", "Total Balance");
+    char balance[32];
+    for (unsigned int t = 0; t < header.type_count; t++) {
+        if (types[t].count == 0) continue;
+        snprintf(balance, sizeof(balance), BANK_MONEY_FMT, BANK_MONEY_ARGS(types[t].balance));
+        printf("%-20s %10ld %20s\n", header.types[t], types[t].count, balance);
+    }
+    snprintf(balance, sizeof(balance), BANK_MONEY_FMT, BANK_MONEY_ARGS(total));
+    printf("%-20s %10ld %20s\n", "All", accounts, balance);
+
+    if (top_size > 0) {
+        // Popping the min-heap yields ascending balances; fill from the back for a descending list.
+        for (int last = top_size - 1; last > 0; last--) {
+            struct StoredAccount smallest = top[0];
+            bank_siftDown(top, last, 0, &top[last]);
+            top[last] = smallest;
+        }
+        printf("\nTop %d balance(s):\n", top_size);
+        struct Account acc;
+        for (int i = 0; i < top_size; i++) {
+            if (!bank_decodeAccount(&header, holders, &top[i], &acc)) continue;
+            snprintf(balance, sizeof(balance), BANK_MONEY_FMT, BANK_MONEY_ARGS(acc.balance));
+            printf("%-15ld %-*.*s %15s %s\n", acc.account_number, BANK_NAME_COLUMN_WIDTH, BANK_NAME_COLUMN_WIDTH,
+                   acc.account_holder_name, balance, acc.account_type);
+        }
+    }
+    fclose(holders);
+    free(top);
+    remove(path);
+    remove(holders_path);
+
+    double seconds = (double)(end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    printf("\nReport read %ld account(s) from a snapshot in %.3f s.\n", accounts, seconds);
+    return 0;
+}
+
+// --- Batch Mode Implementation ---
+// Copies the next comma-separated field into dest and advances *cursor past it.
+static void bank_nextField(char **cursor, char *dest, size_t dest_size) {
+    size_t len = strcspn(*cursor, ",");
+    size_t copy = len < dest_size - 1 ? len : dest_size - 1;
+    memcpy(dest, *cursor, copy);
+    dest[copy] = '\0';
+    *cursor += len;
+    if (**cursor == ',') (*cursor)++;
+}
+
+/*
+ * Applies one transaction per line, non-interactively:
+ *   C,<account_number>,<holder name>,<balance>,<type>   create
+ *   D,<account_number>,<amount>                          deposit
+ *   W,<account_number>,<amount>                          withdraw
+ *   T,<from_account>,<to_account>,<amount>               transfer
+ *   X,<account_number>                                   delete
+ * Blank lines and lines starting with '#' are skipped. Changes go through the
+ * journal with group commit, so many transactions share each fsync.
+ */
+int bank_runBatch(const char *filename) {
+    FILE *in = strcmp(filename, "-") == 0 ? stdin : fopen(filename, "r");
+    if (in == NULL) {
+        perror("Error opening batch file");
+        return 1;
+    }
+
+    struct timespec start, end;
+    timespec_get(&start, TIME_UTC);
+    char line[BANK_MAX_LINE_LENGTH];
+    long line_number = 0, applied = 0, rejected = 0;
+    while (fgets(line, sizeof(line), in) != NULL) {
+        line_number++;
+        line[strcspn(line, "\r\n")] = 0;
+        if (line[0] == '\0' || line[0] == '#') continue;
+
+        char *cursor = line;
+        char op[4], number[32], field[BANK_MAX_NAME_LENGTH];
+        bank_nextField(&cursor, op, sizeof(op));
+        bank_nextField(&cursor, number, sizeof(number));
+        long account_number = strtol(number, NULL, 10);
+        int status = BANK_STATUS_INVALID;
+
+        if (strcmp(op, "C") == 0) {
+            struct Account acc;
+            memset(&acc, 0, sizeof(acc));
+            acc.account_number = account_number;
+            bank_nextField(&cursor, acc.account_holder_name, sizeof(acc.account_holder_name));
+            bank_nextField(&cursor, field, sizeof(field));
+            bool valid = bank_parseMoney(field, &acc.balance);
+            bank_nextField(&cursor, acc.account_type, sizeof(acc.account_type));
+            if (valid) status = bank_openAccount(&acc);
+        } else if (strcmp(op, "D") == 0 || strcmp(op, "W") == 0) {
+            struct Account acc;
+            long long amount;
+            bank_nextField(&cursor, field, sizeof(field));
+            if (bank_parseMoney(field, &amount)) {
+                status = bank_adjustBalance(account_number, amount, op[0] == 'D', &acc);
+            }
+        } else if (strcmp(op, "T") == 0) {
+            struct Account from, to;
+            long long amount;
+            bank_nextField(&cursor, field, sizeof(field));
+            long to_account = strtol(field, NULL, 10);
+            bank_nextField(&cursor, field, sizeof(field));
+            if (bank_parseMoney(field, &amount)) {
+                status = bank_transfer(account_number, to_account, amount, &from, &to);
+            }
+        } else if (strcmp(op, "X") == 0) {
+            status = bank_closeAccount(account_number);
+        }
+
+        if (status == BANK_STATUS_OK) {
+            applied++;
+        } else {
+            rejected++;
+            fprintf(stderr, "Line %ld rejected (status %d): %s\n", line_number, status, line);
+        }
+    }
+    bank_commitTransactions();
+    timespec_get(&end, TIME_UTC);
+    if (in != stdin) fclose(in);
+
+    double seconds = (double)(end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    printf("Batch complete: %ld applied, %ld rejected in %.3f s", applied, rejected, seconds);
+    if (seconds > 0) printf(" (%.0f transactions/sec)", (applied + rejected) / seconds);
+    printf("\n");
+    return rejected == 0 ? 0 : 2;
+}
+
+// Runs bank_applyRates for rules given as "<type>=<percent>" arguments and reports throughput.
+int bank_runApplyRates(int rule_count, char *rule_args[]) {
+    struct RateRule rules[BANK_MAX_RATE_RULES];
+    if (rule_count > BANK_MAX_RATE_RULES) {
+        printf("At most %d account types can be given.\n", BANK_MAX_RATE_RULES);
+        return 1;
+    }
+    for (int i = 0; i < rule_count; i++) {
+        char *equals = strchr(rule_args[i], '=');
+        size_t type_length = equals != NULL ? (size_t)(equals - rule_args[i]) : 0;
+        if (type_length == 0 || type_length >= BANK_MAX_TYPE_LENGTH || !bank_parseRate(equals + 1, &rules[i].basis_points)) {
+            printf("Invalid rate \"%s\". Use <type>=<percent>, e.g. Savings=1.25 or Current=-0.10.\n", rule_args[i]);
+            return 1;
+        }
+        memset(rules[i].account_type, 0, BANK_MAX_TYPE_LENGTH);
+        memcpy(rules[i].account_type, rule_args[i], type_length);
+    }
+
+    struct timespec start, end;
+    timespec_get(&start, TIME_UTC);
+    long changed;
+    long scanned = bank_applyRates(rules, rule_count, &changed);
+    timespec_get(&end, TIME_UTC);
+    if (scanned < 0) return 1;
+
+    double seconds = (double)(end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    printf("Rates applied: %ld of %ld account(s) changed in %.3f s", changed, scanned, seconds);
+    if (seconds > 0) printf(" (%.0f accounts/sec)", scanned / seconds);
+    printf("\n");
+    return 0;
+}
+
+// Forks client processes that each deposit into randomly chosen existing
+// accounts, committing every transaction, and reports combined throughput.
+int bank_runLoadTest(int clients, long transactions_per_client) {
+    #ifdef _WIN32
+        (void)clients; (void)transactions_per_client;
+        printf("The load test needs fork() and is not available on Windows.\n");
+        return 1;
+    #else
+        FILE *idx = fopen(BANK_INDEX_FILENAME, "rb");
+        long entry_count = idx != NULL ? rs_countRecords(idx, sizeof(struct AccountIndexEntry)) : 0;
+        if (idx != NULL) fclose(idx);
+        if (clients <= 0 || transactions_per_client <= 0 || entry_count == 0) {
+            printf("The load test needs a positive client and transaction count, and existing accounts.\n");
+            return 1;
+        }
+
+        fflush(stdout);
+        fflush(bank_journal);
+        struct timespec start, end;
+        timespec_get(&start, TIME_UTC);
+        for (int c = 0; c < clients; c++) {
+            pid_t pid = fork();
+            if (pid < 0) {
+                perror("Error starting load test client");
+                break;
+            }
+            if (pid == 0) {
+                srand((unsigned int)getpid());
+                bank_writer_id = bank_newWriterId(); // A crashed client's records are not the parent's to skip
+                FILE *client_idx = fopen(BANK_INDEX_FILENAME, "rb");
+                long failures = 0;
+                struct AccountIndexEntry entry;
+                struct Account acc;
+                for (long t = 0; t < transactions_per_client && client_idx != NULL; t++) {
+                    long pos = (long)(((unsigned long)rand() * ((unsigned long)RAND_MAX + 1) + (unsigned long)rand()) % (unsigned long)entry_count);
+                    fseek(client_idx, pos * (long)sizeof(struct AccountIndexEntry), SEEK_SET);
+                    if (fread(&entry, sizeof(struct AccountIndexEntry), 1, client_idx) != 1 ||
+                        bank_adjustBalance(entry.account_number, 100, true, &acc) != BANK_STATUS_OK) {
+                        failures++;
+                        continue;
+                    }
+                    bank_commitTransactions();
+                }
+                if (client_idx != NULL) fclose(client_idx);
+                _exit(failures == 0 ? 0 : 1);
+            }
+        }
+
+        int failed_clients = 0, status;
+        while (wait(&status) > 0) {
+            if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) failed_clients++;
+        }
+        timespec_get(&end, TIME_UTC);
+
+        double seconds = (double)(end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+        long total = (long)clients * transactions_per_client;
+        printf("Load test: %d client(s), %ld transactions in %.3f s (%.0f transactions/sec)",
+               clients, total, seconds, seconds > 0 ? total / seconds : 0.0);
+        if (failed_clients > 0) printf(", %d client(s) reported failures", failed_clients);
+        printf("\n");
+        return failed_clients == 0 ? 0 : 2;
+    #endif
+}
+
+// Removes the files of a benchmark run; holders files of every generation it reached.
+static void bank_removeBenchFiles() {
+    const char *files[] = { BANK_FILENAME, BANK_INDEX_FILENAME, BANK_NAME_INDEX_FILENAME,
+                            BANK_JOURNAL_FILENAME, BANK_FREE_FILENAME, BANK_LOCK_FILENAME };
+    struct BankFileHeader header;
+    char path[64];
+    FILE *fp = fopen(BANK_FILENAME, "rb");
+    unsigned int generation = fp != NULL && bank_readHeader(fp, &header) ? header.holders_generation : 1;
+    if (fp != NULL) fclose(fp);
+    for (unsigned int g = 1; g <= generation; g++) {
+        bank_holdersPath(path, sizeof(path), g);
+        remove(path);
+    }
+    for (size_t i = 0; i < sizeof(files) / sizeof(files[0]); i++) remove(files[i]);
+}
+
+static const char *bank_bench_types[] = { "Savings", "Current", "Fixed Deposit", "Gold" };
+
+// Writes a data file of the given number of synthetic accounts straight to
+// disk; the indexes are built by bank_openJournal, the way startup builds them.
+static bool bank_writeBenchFile(long records) {
+    struct BankFileHeader header;
+    bank_initHeader(&header, 1);
+    FILE *fp = fopen(BANK_FILENAME, "wb");
+    FILE *holders = bank_holdersFile(&header);
+    bool ok = fp != NULL && holders != NULL && bank_writeHeader(fp, &header);
+    struct Account acc;
+    struct StoredAccount rec;
+    for (long i = 0; ok && i < records; i++) {
+        memset(&acc, 0, sizeof(acc));
+        acc.account_number = i + 1;
+        snprintf(acc.account_holder_name, BANK_MAX_NAME_LENGTH, "Holder %ld", i + 1);
+        acc.balance = (i * 7919) % 10000000;
+        strcpy(acc.account_type, bank_bench_types[i % 4]);
+        ok = bank_encodeAccount(&header, holders, &acc, &rec) && fwrite(&rec, sizeof(rec), 1, fp) == 1;
+    }
+    ok = ok && bank_writeHeader(fp, &header); // Now with the type dictionary filled in
+    if (fp != NULL && fclose(fp) != 0) ok = false;
+    if (!ok) perror("Error generating benchmark data");
+    return ok;
+}
+
+// Closes everything a benchmark opened and removes its files.
+static void bank_finishBench() {
+    bank_closeJournal();
+    if (bank_holders != NULL) {
+        fclose(bank_holders);
+        bank_holders = NULL;
+    }
+    bank_removeBenchFiles();
+}
+
+/*
+ * Times full scans, lookups, balance updates, creates and deletes against a
+ * synthetic data file of the given size and prints one JSON line per operation.
+ * Changes go through the journal and are committed one at a time, as the menu
+ * does. The data file is written directly and indexed the way startup indexes
+ * any file, so a large run does not spend its time on setup. Runs in
+ * BANK_BENCH_DIR, starting from and leaving behind an empty directory.
+ */
+int bank_runBench(long records, int operations) {
+    if (records <= 0) records = BANK_BENCH_RECORDS;
+    if (operations <= 0) operations = BANK_BENCH_OPERATIONS;
+    if (!bench_enterDir(BANK_BENCH_DIR)) return 1;
+    bank_removeBenchFiles();
+    bank_openLockFile();
+
+    double *samples = (double *)malloc(operations * sizeof(double));
+    if (samples == NULL || !bank_writeBenchFile(records)) {
+        free(samples);
+        return 1;
+    }
+    bank_openJournal(); // Builds the indexes
+    struct Account acc;
+    srand(12345); // Same accounts every run, so results are comparable
+
+    long failures = 0;
+    struct ListingCursor cursor;
+    for (int op = 0; op < operations; op++) {
+        long listed = 0;
+        double start = bench_nowMicros();
+        if (bank_openListing(&cursor, BANK_ORDER_STORED, "")) {
+            while (bank_nextListed(&cursor, &acc)) listed++;
+            bank_closeListing(&cursor);
+        }
+        samples[op] = bench_nowMicros() - start;
+        if (listed != records) failures++;
+    }
+    bench_printResult("bank", "scan", records, samples, operations);
+
+    for (int op = 0; op < operations; op++) {
+        long account_number = (long)(((unsigned long)rand() * ((unsigned long)RAND_MAX + 1) + (unsigned long)rand()) % (unsigned long)records) + 1;
+        double start = bench_nowMicros();
+        if (!bank_lookupAccount(account_number, &acc)) failures++;
+        samples[op] = bench_nowMicros() - start;
+    }
+    bench_printResult("bank", "lookup", records, samples, operations);
+
+    for (int op = 0; op < operations; op++) {
+        long account_number = (long)(((unsigned long)rand() * ((unsigned long)RAND_MAX + 1) + (unsigned long)rand()) % (unsigned long)records) + 1;
+        double start = bench_nowMicros();
+        if (bank_adjustBalance(account_number, 100, true, &acc) == BANK_STATUS_OK) {
+            bank_commitTransactions();
+        } else {
+            failures++;
+        }
+        samples[op] = bench_nowMicros() - start;
+    }
+    bench_printResult("bank", "update", records, samples, operations);
+
+    for (int op = 0; op < operations; op++) {
+        memset(&acc, 0, sizeof(acc));
+        acc.account_number = records + op + 1;
+        snprintf(acc.account_holder_name, BANK_MAX_NAME_LENGTH, "Holder %ld", acc.account_number);
+        strcpy(acc.account_type, bank_bench_types[op % 4]);
+        double start = bench_nowMicros();
+        if (bank_openAccount(&acc) == BANK_STATUS_OK) {
+            bank_commitTransactions();
+        } else {
+            failures++;
+        }
+        samples[op] = bench_nowMicros() - start;
+    }
+    bench_printResult("bank", "create", records, samples, operations);
+
+    for (int op = 0; op < operations; op++) { // Closes the accounts just created, back to the generated set
+        double start = bench_nowMicros();
+        if (bank_closeAccount(records + op + 1) == BANK_STATUS_OK) {
+            bank_commitTransactions();
+        } else {
+            failures++;
+        }
+        samples[op] = bench_nowMicros() - start;
+    }
+    bench_printResult("bank", "delete", records, samples, operations);
+
+    bank_finishBench();
+    free(samples);
+    if (failures > 0) printf("Benchmark: %ld operation(s) failed.\n", failures);
+    return failures == 0 ? 0 : 1;
+}
+
+/*
+ * Times bank_applyRates over a synthetic data file of the given size (default
+ * 10M accounts), BANK_BENCH_RATE_RUNS passes with a rule for three of the four
+ * account types. Prints one JSON line, whose latencies are per pass, and the
+ * median pass as accounts/sec on stderr. Runs in BANK_BENCH_DIR.
+ */
+int bank_runRateBench(long records) {
+    if (records <= 0) records = BANK_BENCH_RATE_RECORDS;
+    if (!bench_enterDir(BANK_BENCH_DIR)) return 1;
+    bank_removeBenchFiles();
+    bank_openLockFile();
+    if (!bank_writeBenchFile(records)) return 1;
+    bank_openJournal();
+
+    struct RateRule rules[3];
+    memset(rules, 0, sizeof(rules));
+    strcpy(rules[0].account_type, "Savings");
+    rules[0].basis_points = 125;
+    strcpy(rules[1].account_type, "Current");
+    rules[1].basis_points = -10;
+    strcpy(rules[2].account_type, "Gold");
+    rules[2].basis_points = 200;
+    double samples[BANK_BENCH_RATE_RUNS];
+    bool ok = true;
+    for (int run = 0; run < BANK_BENCH_RATE_RUNS; run++) {
+        long changed;
+        double start = bench_nowMicros();
+        if (bank_applyRates(rules, 3, &changed) != records) ok = false;
+        samples[run] = bench_nowMicros() - start;
+    }
+    bench_printResult("bank", "apply_rates", records, samples, BANK_BENCH_RATE_RUNS);
+    fprintf(stderr, "apply_rates: %.0f accounts/sec\n", records / (samples[BANK_BENCH_RATE_RUNS / 2] / 1e6));
+
+    bank_finishBench();
+    if (!ok) printf("Benchmark: a rate pass failed.\n");
+    return ok ? 0 : 1;
+}
+
+/*
+ * Converts a data file in an older layout to the current format: raw struct
+ * Account records (version 1), or, with float_balances, the layout from before
+ * balances were whole cents, rounding each balance to the nearest cent. Holder
+ * names move to the holders file and account types into the header's
+ * dictionary. The old file is kept as BANK_FILENAME ".v1.bak" (or ".float.bak").
+ */
+int bank_convertLegacy(bool float_balances) {
+    const char *backup = float_balances ? BANK_FILENAME ".float.bak" : BANK_FILENAME ".v1.bak";
+    bank_lockRange(BANK_LOCK_TABLE, 1, BANK_LOCK_EXCLUSIVE, true);
+    FILE *in = fopen(BANK_FILENAME, "rb");
+    if (in == NULL) {
+        printf("Nothing to convert: %s does not exist.\n", BANK_FILENAME);
+        bank_releaseLocks();
+        return 0;
+    }
+    struct BankFileHeader header;
+    if (bank_readHeader(in, &header)) {
+        printf("%s is already in the current format.\n", BANK_FILENAME);
+        fclose(in);
+        bank_releaseLocks();
+        return 0;
+    }
+    fseek(in, 0, SEEK_SET);
+
+    char holders_path[64];
+    bank_initHeader(&header, 1);
+    bank_holdersPath(holders_path, sizeof(holders_path), header.holders_generation);
+    FILE *holders = fopen(holders_path, "w+b");
+    FILE *out = fopen(BANK_TEMP_FILENAME, "wb");
+    if (holders == NULL || out == NULL) {
+        perror("Error opening file for saving accounts");
+        fclose(in);
+        if (holders != NULL) fclose(holders);
+        if (out != NULL) fclose(out);
+        bank_releaseLocks();
+        return 1;
+    }
+
+    struct LegacyAccount old_acc;
+    struct Account acc;
+    struct StoredAccount rec;
+    long converted = 0;
+    bool ok = bank_writeHeader(out, &header);
+    while (ok) {
+        if (float_balances) {
+            if (fread(&old_acc, sizeof(struct LegacyAccount), 1, in) != 1) break;
+            memset(&acc, 0, sizeof(acc));
+            acc.account_number = old_acc.account_number;
+            memcpy(acc.account_holder_name, old_acc.account_holder_name, BANK_MAX_NAME_LENGTH);
+            acc.balance = (long long)(old_acc.balance * 100.0 + (old_acc.balance < 0 ? -0.5 : 0.5));
+            memcpy(acc.account_type, old_acc.account_type, BANK_MAX_TYPE_LENGTH);
+        } else if (fread(&acc, sizeof(struct Account), 1, in) != 1) {
+            break;
+        }
+        acc.account_holder_name[BANK_MAX_NAME_LENGTH - 1] = '\0';
+        acc.account_type[BANK_MAX_TYPE_LENGTH - 1] = '\0';
+        if (acc.account_number == BANK_TOMBSTONE) {
+            memset(&rec, 0, sizeof(rec)); // Keep the slot so the free list stays valid
+            rec.checksum = bank_checksum(&rec, offsetof(struct StoredAccount, checksum));
+        } else {
+            ok = bank_encodeAccount(&header, holders, &acc, &rec);
+            converted++;
+        }
+        ok = ok && fwrite(&rec, sizeof(struct StoredAccount), 1, out) == 1;
+    }
+    fclose(in);
+    ok = ok && bank_writeHeader(out, &header); // Now with the full type dictionary
+    rs_syncFile(holders);
+    fclose(holders);
+    rs_syncFile(out);
+    fclose(out);
+
+    if (ok && rename(BANK_FILENAME, backup) != 0) {
+        perror("Error keeping a backup of the old file");
+        ok = false;
+    } else if (ok && !rs_replaceFile(BANK_TEMP_FILENAME, BANK_FILENAME)) {
+        perror("Error converting accounts");
+        rename(backup, BANK_FILENAME); // Put the old file back rather than leave none
+        ok = false;
+    }
+    if (!ok) {
+        printf("Error: Could not convert %s; it is unchanged.\n", BANK_FILENAME);
+        remove(BANK_TEMP_FILENAME);
+        remove(holders_path); // A legacy file keeps its names inline, so nothing else uses it
+        bank_releaseLocks();
+        return 1;
+    }
+    bank_rebuildIndex();
+    bank_rebuildNameIndex();
+    bank_releaseLocks();
+    printf("Converted %ld account(s) to format version %d. The old file was kept as %s.\n",
+           converted, BANK_FORMAT_VERSION, backup);
+    return 0;
+}
+
+// --- CRUD Operations Implementation ---
+void bank_createAccount() {
+    bank_clearScreen();
+    printf("--- Create New Account ---\n");
+    struct Account new_acc;
+    memset(&new_acc, 0, sizeof(new_acc));
+
+    printf("Enter Account Number (e.g., 1001): ");
+    while (scanf("%ld", &new_acc.account_number) != 1 || new_acc.account_number <= 0) {
+        printf("Invalid Account Number. Enter a positive number: ");
+        bank_clearInputBuffer();
+    }
+    bank_clearInputBuffer();
+
+    if (bank_accountExists(new_acc.account_number)) {
+        printf("Error: Account Number %ld already exists. Please use a unique Account Number.\n", new_acc.account_number);
+        return;
+    }
+
+    printf("Enter Account Holder Name (max %d chars): ", BANK_MAX_NAME_LENGTH - 1);
+    fgets(new_acc.account_holder_name, BANK_MAX_NAME_LENGTH, stdin);
+    new_acc.account_holder_name[strcspn(new_acc.account_holder_name, "\n")] = 0;
+    if (strlen(new_acc.account_holder_name) == 0) {
+        printf("Account Holder Name cannot be empty. Please try again.\n");
+        return;
+    }
+
+    printf("Enter Initial Balance (0 or more): ");
+    new_acc.balance = bank_readMoney(true);
+
+    printf("Enter Account Type (e.g., Savings, Current - max %d chars): ", BANK_MAX_TYPE_LENGTH - 1);
+    fgets(new_acc.account_type, BANK_MAX_TYPE_LENGTH, stdin);
+    new_acc.account_type[strcspn(new_acc.account_type, "\n")] = 0;
+    if (strlen(new_acc.account_type) == 0) {
+        printf("Account Type cannot be empty. Please try again.\n");
+        return;
+    }
+
+
+    int status = bank_openAccount(&new_acc);
+    if (status == BANK_STATUS_OK) {
+        bank_commitTransactions();
+        printf("\nAccount created successfully!\n");
+    } else if (status == BANK_STATUS_EXISTS) {
+        printf("Error: Account Number %ld already exists. Please use a unique Account Number.\n", new_acc.account_number);
+    } else if (status == BANK_STATUS_INVALID) {
+        printf("Error: Too many distinct account types; at most %d are supported. Use an existing type.\n", BANK_MAX_ACCOUNT_TYPES);
+    } else {
+        printf("Error: Could not save the account. Please try again.\n");
+    }
+}
+
+void bank_displayAllAccounts() {
+    bank_clearScreen();
+    printf("--- All Bank Accounts ---\n");
+    int order;
+    char type_filter[BANK_MAX_TYPE_LENGTH];
+
+    printf("Order by:\n1. Storage order (fastest)\n2. Account Number\n3. Balance (highest first)\n4. Balance (lowest first)\nEnter choice: ");
+    while (scanf("%d", &order) != 1 || order < BANK_ORDER_STORED || order > BANK_ORDER_BALANCE_ASC) {
+        printf("Invalid choice. Enter a number between 1 and 4: ");
+        bank_clearInputBuffer();
+    }
+    bank_clearInputBuffer();
+    printf("Show only Account Type (leave empty for all): ");
+    fgets(type_filter, BANK_MAX_TYPE_LENGTH, stdin);
+    type_filter[strcspn(type_filter, "\n")] = 0;
+
+    bank_lockRange(BANK_LOCK_TABLE, 1, BANK_LOCK_SHARED, true);
+    struct ListingCursor cursor;
+    if (!bank_openListing(&cursor, order, type_filter)) {
+        bank_lockRange(BANK_LOCK_TABLE, 1, BANK_LOCK_NONE, false);
+        printf("\nNo bank accounts found.\n");
+        return;
+    }
+
+    // Each page is formatted into one buffer and written with a single call.
+    char page[(BANK_PAGE_SIZE + 4) * 128];
+    const char *rule = "--------------------------------------------------------------------------------------\n";
+    struct Account acc;
+    long listed = 0;
+    bool more = bank_nextListed(&cursor, &acc);
+    bank_lockRange(BANK_LOCK_TABLE, 1, BANK_LOCK_NONE, false); // Only held while reading, not while the user pages
+    while (more) {
+        int length = snprintf(page, sizeof(page), "%s%-15s %-*s %-15s %-15s\n%s", rule, "Account No.",
+                              BANK_NAME_COLUMN_WIDTH, "Holder Name", "Balance", "Type", rule);
+        bank_lockRange(BANK_LOCK_TABLE, 1, BANK_LOCK_SHARED, true);
+        for (int row = 0; row < BANK_PAGE_SIZE && more; row++) {
+            char balance[32];
+            snprintf(balance, sizeof(balance), BANK_MONEY_FMT, BANK_MONEY_ARGS(acc.balance));
+            length += snprintf(page + length, sizeof(page) - length, "%-15ld %-*.*s %-15s %-15s\n",
+                               acc.account_number, BANK_NAME_COLUMN_WIDTH, BANK_NAME_COLUMN_WIDTH,
+                               acc.account_holder_name, balance, acc.account_type);
+            listed++;
+            more = bank_nextListed(&cursor, &acc);
+        }
+        bank_lockRange(BANK_LOCK_TABLE, 1, BANK_LOCK_NONE, false);
+        length += snprintf(page + length, sizeof(page) - length, "%s", rule);
+        fwrite(page, 1, length, stdout);
+
+        if (more) {
+            printf("Shown %ld so far. Press Enter for the next page, or q then Enter to stop: ", listed);
+            int c = getchar();
+            if (c != '\n') bank_clearInputBuffer();
+            if (c == 'q' || c == 'Q' || c == EOF) break;
+        }
+    }
+    bank_closeListing(&cursor);
+
+    if (listed == 0) {
+        printf("\nNo bank accounts found.\n");
+    }
+}
+
+void bank_searchAccount() {
+    bank_clearScreen();
+    printf("--- Search Account ---\n");
+    int choice;
+
+    printf("Search by:\n1. Account Number\n2. Holder Name (full or beginning, any case)\nEnter choice: ");
+    while (scanf("%d", &choice) != 1 || (choice != 1 && choice != 2)) {
+        printf("Invalid choice. Enter 1 or 2: ");
+        bank_clearInputBuffer();
+    }
+    bank_clearInputBuffer();
+
+    long account_numbers[BANK_MAX_SEARCH_RESULTS];
+    long matches;
+    struct Account acc;
+    if (choice == 1) {
+        printf("Enter Account Number to search: ");
+        while (scanf("%ld", &account_numbers[0]) != 1 || account_numbers[0] <= 0) {
+            printf("Invalid Account Number. Enter a positive number: ");
+            bank_clearInputBuffer();
+        }
+        bank_clearInputBuffer();
+        matches = 1;
+    } else {
+        char search_name[BANK_MAX_NAME_LENGTH];
+        printf("Enter Holder Name to search: ");
+        fgets(search_name, BANK_MAX_NAME_LENGTH, stdin);
+        search_name[strcspn(search_name, "\n")] = 0;
+        bank_lockRange(BANK_LOCK_TABLE, 1, BANK_LOCK_SHARED, true);
+        matches = bank_findByName(search_name, account_numbers, BANK_MAX_SEARCH_RESULTS);
+        bank_lockRange(BANK_LOCK_TABLE, 1, BANK_LOCK_NONE, false);
+    }
+
+    long shown = 0;
+    bank_lockRange(BANK_LOCK_TABLE, 1, BANK_LOCK_SHARED, true); // No create or delete mid-way through the index
+    for (long i = 0; i < matches && i < BANK_MAX_SEARCH_RESULTS; i++) {
+        if (!bank_lookupAccount(account_numbers[i], &acc)) continue;
+        printf("\nAccount Found:\n");
+        printf("Account Number: %ld\nHolder Name: %s\nBalance: " BANK_MONEY_FMT "\nType: %s\n",
+               acc.account_number, acc.account_holder_name,
+               BANK_MONEY_ARGS(acc.balance), acc.account_type);
+        shown++;
+    }
+    bank_lockRange(BANK_LOCK_TABLE, 1, BANK_LOCK_NONE, false);
+
+    if (shown == 0) {
+        if (choice == 1) {
+            printf("\nAccount with Number %ld not found.\n", account_numbers[0]);
+        } else {
+            printf("\nNo account holder name matches.\n");
+        }
+    } else if (matches > BANK_MAX_SEARCH_RESULTS) {
+        printf("\n... and %ld more. Enter more of the name to narrow the search.\n", matches - BANK_MAX_SEARCH_RESULTS);
+    }
+}
+
+void bank_depositWithdraw(bool is_deposit) {
+    bank_clearScreen();
+    printf("--- %s Money ---\n", is_deposit ? "Deposit" : "Withdraw");
+    long acc_num;
+
+    printf("Enter Account Number: ");
+    while (scanf("%ld", &acc_num) != 1 || acc_num <= 0) {
+        printf("Invalid Account Number. Enter a positive number: ");
+        bank_clearInputBuffer();
+    }
+    bank_clearInputBuffer();
+
+    printf("Enter Amount to %s: ", is_deposit ? "Deposit" : "Withdraw");
+    long long amount = bank_readMoney(false);
+
+    struct Account acc;
+    switch (bank_adjustBalance(acc_num, amount, is_deposit, &acc)) {
+        case BANK_STATUS_OK:
+            bank_commitTransactions(); // Durable in the journal before it touches the data file
+            if (is_deposit) {
+                printf("\nDeposit successful! New balance for %ld: " BANK_MONEY_FMT "\n", acc_num, BANK_MONEY_ARGS(acc.balance));
+            } else {
+                printf("\nWithdrawal successful! New balance for %ld: " BANK_MONEY_FMT "\n", acc_num, BANK_MONEY_ARGS(acc.balance));
+            }
+            break;
+        case BANK_STATUS_NOT_FOUND:
+            printf("\nAccount with Number %ld not found.\n", acc_num);
+            break;
+        case BANK_STATUS_INSUFFICIENT_FUNDS:
+            printf("\nInsufficient balance for withdrawal. Current balance: " BANK_MONEY_FMT "\n", BANK_MONEY_ARGS(acc.balance));
+            break;
+        default: break;
+    }
+}
+
+void bank_transferMoney() {
+    bank_clearScreen();
+    printf("--- Transfer Money ---\n");
+    long from_acc_num, to_acc_num;
+
+    printf("Enter Account Number to transfer from: ");
+    while (scanf("%ld", &from_acc_num) != 1 || from_acc_num <= 0) {
+        printf("Invalid Account Number. Enter a positive number: ");
+        bank_clearInputBuffer();
+    }
+    bank_clearInputBuffer();
+
+    printf("Enter Account Number to transfer to: ");
+    while (scanf("%ld", &to_acc_num) != 1 || to_acc_num <= 0 || to_acc_num == from_acc_num) {
+        printf("Invalid Account Number. Enter a different positive number: ");
+        bank_clearInputBuffer();
+    }
+    bank_clearInputBuffer();
+
+    printf("Enter Amount to Transfer: ");
+    long long amount = bank_readMoney(false);
+
+    struct Account from, to;
+    switch (bank_transfer(from_acc_num, to_acc_num, amount, &from, &to)) {
+        case BANK_STATUS_OK:
+            bank_commitTransactions();
+            printf("\nTransfer successful!\n");
+            printf("New balance for %ld: " BANK_MONEY_FMT "\n", from_acc_num, BANK_MONEY_ARGS(from.balance));
+            printf("New balance for %ld: " BANK_MONEY_FMT "\n", to_acc_num, BANK_MONEY_ARGS(to.balance));
+            break;
+        case BANK_STATUS_NOT_FOUND:
+            printf("\nBoth accounts must exist. Check the account numbers and try again.\n");
+            break;
+        case BANK_STATUS_INSUFFICIENT_FUNDS:
+            printf("\nInsufficient balance for transfer. Current balance: " BANK_MONEY_FMT "\n", BANK_MONEY_ARGS(from.balance));
+            break;
+        default: break;
+    }
+}
+
+void bank_applyInterestFees() {
+    bank_clearScreen();
+    printf("--- Apply Interest/Fees by Account Type ---\n");
+    printf("Enter one account type and rate per line. Use a negative rate for a fee\n");
+    printf("(e.g. Savings then 1.25, or Current then -0.10). Leave the type empty to finish.\n");
+
+    struct RateRule rules[BANK_MAX_RATE_RULES];
+    int rule_count = 0;
+    char line[BANK_MAX_LINE_LENGTH];
+    while (rule_count < BANK_MAX_RATE_RULES) {
+        char *type = rules[rule_count].account_type;
+        printf("\nAccount Type: ");
+        memset(type, 0, BANK_MAX_TYPE_LENGTH);
+        if (fgets(type, BANK_MAX_TYPE_LENGTH, stdin) == NULL) break;
+        type[strcspn(type, "\n")] = 0;
+        if (type[0] == '\0') break;
+
+        printf("Rate in percent: ");
+        bool have_rate = false;
+        while (!have_rate && fgets(line, sizeof(line), stdin) != NULL) {
+            have_rate = bank_parseRate(line, &rules[rule_count].basis_points);
+            if (!have_rate) printf("Invalid rate. Enter a percentage between -100 and 100 with at most two decimals: ");
+        }
+        if (!have_rate) break; // Input ended before a rate was given; the type is dropped
+        rule_count++;
+    }
+    if (rule_count == 0) {
+        printf("\nNo rates entered. Nothing was changed.\n");
+        return;
+    }
+
+    long changed;
+    long scanned = bank_applyRates(rules, rule_count, &changed);
+    if (scanned >= 0) {
+        printf("\nRates applied to %ld of %ld account(s).\n", changed, scanned);
+    }
+}
+
+void bank_balanceReport() {
+    bank_clearScreen();
+    int top_count;
+    printf("How many of the largest balances to list (e.g., %d): ", BANK_REPORT_TOP);
+    while (scanf("%d", &top_count) != 1 || top_count < 0) {
+        printf("Invalid count. Enter 0 or a positive number: ");
+        bank_clearInputBuffer();
+    }
+    bank_clearInputBuffer();
+    bank_runReport(top_count);
+}
+
+void bank_deleteAccount() {
+    bank_clearScreen();
+    printf("--- Delete Account ---\n");
+    long delete_acc_num;
+
+    printf("Enter Account Number to delete: ");
+    while (scanf("%ld", &delete_acc_num) != 1 || delete_acc_num <= 0) {
+        printf("Invalid Account Number. Enter a positive number: ");
+        bank_clearInputBuffer();
+    }
+    bank_clearInputBuffer();
+
+    int status = bank_closeAccount(delete_acc_num);
+    if (status == BANK_STATUS_NOT_FOUND) {
+        printf("\nAccount with Number %ld not found.\n", delete_acc_num);
+        return;
+    }
+    if (status != BANK_STATUS_OK) return;
+    bank_commitTransactions();
+    printf("\nAccount with Number %ld deleted successfully!\n", delete_acc_num);
 }
\ No newline at end of file
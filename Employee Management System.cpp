@@ -2,6 +2,17 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
+#include <ctype.h>
+#include <math.h>
+#include <time.h>
+#include <algorithm> // std::nth_element for payroll medians
+#include <thread>    // Payroll report workers
+
+// SSE2 is part of every x86-64 target; other targets use the scalar name search
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define EMP_HAVE_SSE2 1
+#endif
 
 #ifdef _WIN32
     #include <windows.h>
@@ -9,20 +20,151 @@
     #include <unistd.h>
 #endif
 
+#include "record_store.h"
+#include "bench.h"
+
 // --- Constants ---
 #define EMP_FILENAME "employees.dat"
+#define EMP_INDEX_FILENAME "employees.idx" // Sorted employee_id -> slot, kept by the record store
+#define EMP_FREE_FILENAME "employees_free.lst" // Slots of deleted employees, reused by the next add
+#define EMP_FORMAT_MAGIC "EMPLOYE" // First 8 bytes of a data file in the current format
+#define EMP_FORMAT_VERSION 3 // 1: no header, hire date as a "YYYY-MM-DD" string; 2: department name in every record
+#define EMP_SALARY_INDEX_FILENAME "employees_salary.idx" // Sorted (salary in cents, employee_id) -> slot
+#define EMP_HIRED_INDEX_FILENAME "employees_hired.idx" // Sorted (hire date as YYYYMMDD, employee_id) -> slot
 #define EMP_MAX_NAME_LENGTH 100
 #define EMP_MAX_DEPT_LENGTH 50
-#define EMP_MAX_DATE_LENGTH 15 // e.g., "YYYY-MM-DD"
-#define EMP_MAX_EMPLOYEES 1000
+#define EMP_MAX_SALARY 100000000.0f // Highest salary; exported with %.2f it has 9 whole digits, which CSV import accepts
+#define EMP_MAX_RAISE_PERCENT 1000.0f // Largest department raise; keeps salary * (100 + percent) well inside a long long
+#define EMP_MAX_DEPARTMENTS 128 // Size of the department dictionary in the file header
+#define EMP_MAX_DATE_LENGTH 15 // Input buffer for "YYYY-MM-DD"
+#define EMP_MAX_EMPLOYEES 1000 // Most employees a range search lists, and the largest --bench file
+#define EMP_BENCH_DIR "employee_bench" // Scratch directory for --bench; the real employees.dat is never touched
+#define EMP_BENCH_OPERATIONS 200 // Timed repetitions of each benchmark operation unless another count is given
+#define EMP_BENCH_NAME_ROWS 1000000 // Names in the name search benchmark, independent of the record count
+#define EMP_BENCH_PAYROLL_RECORDS 10000000 // Default size of the --bench-payroll file
+#define EMP_BENCH_PAYROLL_RUNS 5 // Timed payroll reports per thread count
+#define EMP_BENCH_CSV_ROWS 200000 // Rows in the CSV import/export benchmark
+#define EMP_BENCH_CSV_RUNS 5 // Timed imports and exports
+#define EMP_BENCH_CSV_FILENAME "employees_bench.csv"
+#define EMP_CSV_HEADER "employee_id,name,department,salary,hire_date"
+#define EMP_CSV_MIN_CHUNK (1024 * 1024) // Smallest slice of a CSV file given its own parsing thread
+#define EMP_PAYROLL_BLOCK 4096 // Records per read in a payroll worker
+#define EMP_MAX_THREADS 64
+#define EMP_TOP_DEFAULT 10 // Employees listed by Salary Statistics unless another count is given
+#define EMP_COHORT_YEARS 10000 // Hire cohorts are indexed by year; 0 holds unknown hire dates
+#define EMP_NAME_COLUMN_PADDING (EMP_MAX_NAME_LENGTH + 16) // Zero bytes after the last name, so vector loads never leave the buffer
 
 // --- Structure Definition ---
 struct Employee {
+    int employee_id;
+    char name[EMP_MAX_NAME_LENGTH];
+    unsigned char department_code; // Index into the header's department dictionary; 0 is no department
+    float salary;
+    int hire_date; // YYYYMMDD, so dates compare as integers; 0 if unknown
+};
+
+// Record layout of version 2 files; read only by --convert-format.
+struct EmployeeV2 {
     int employee_id;
     char name[EMP_MAX_NAME_LENGTH];
     char department[EMP_MAX_DEPT_LENGTH];
     float salary;
-    char hire_date[EMP_MAX_DATE_LENGTH]; // Stored as YYYY-MM-DD string
+    int hire_date;
+};
+
+// Record layout of version 1 files; read only by --convert-format.
+struct LegacyEmployee {
+    int employee_id;
+    char name[EMP_MAX_NAME_LENGTH];
+    char department[EMP_MAX_DEPT_LENGTH];
+    float salary;
+    char hire_date[EMP_MAX_DATE_LENGTH];
+};
+
+struct EmpFileHeader {
+    char magic[8];                 // EMP_FORMAT_MAGIC
+    unsigned int version;          // EMP_FORMAT_VERSION
+    unsigned int record_size;      // sizeof(struct Employee)
+    unsigned int department_count; // Entries used in departments; codes are never reused or renumbered
+    char departments[EMP_MAX_DEPARTMENTS][EMP_MAX_DEPT_LENGTH]; // departments[0] is "" (no department)
+};
+
+// The version 2 header, which is also the start of the current one.
+struct EmpFileHeaderV2 {
+    char magic[8];
+    unsigned int version;
+    unsigned int record_size;
+};
+
+// One entry of a salary or hire date index. Entries are sorted by key, then
+// employee_id, so a range query is a binary search followed by a sequential read.
+struct EmpIndexEntry {
+    long long key; // Salary in cents, or hire date as YYYYMMDD
+    int employee_id;
+    int slot;      // Record position in EMP_FILENAME
+};
+
+// Lower-cased copies of the employee names packed end to end, each followed by
+// '\0', so a substring search is one pass over a single buffer. A needle never
+// contains '\0', so a match cannot run from one name into the next.
+struct EmpNameColumn {
+    char *text;      // Folded names, then EMP_NAME_COLUMN_PADDING zero bytes
+    size_t length;   // Bytes used by names and their terminators
+    size_t capacity; // Bytes allocated for text
+    int *starts;     // Offset in text of each name, in load order
+    int count;
+    int row_capacity;
+};
+
+// Payroll figures for one department. Every salary is kept for the median.
+struct EmpDeptStats {
+    long headcount;
+    double total_salary;
+    float min_salary;
+    float max_salary;
+    float *salaries;
+    long salary_capacity;
+};
+
+struct EmpPayrollTotals {
+    struct EmpDeptStats departments[EMP_MAX_DEPARTMENTS]; // By department code
+    long employees;
+    long cohort_count[EMP_COHORT_YEARS];
+    double cohort_salary[EMP_COHORT_YEARS];
+};
+
+// The slots [first_slot, end_slot) of the data file, aggregated by one worker thread.
+struct EmpPayrollPart {
+    long first_slot;
+    long end_slot;
+    bool ok;
+    struct EmpPayrollTotals totals;
+};
+
+// One slice of a CSV file, from the start of a line to the start of another,
+// parsed into rows by one import thread.
+struct EmpCsvChunk {
+    const char *begin;
+    const char *end;
+    struct Employee *rows;
+    long count;
+    long capacity;
+    const char *error_line; // First line that failed to parse, or NULL
+    const char *error;
+    // Departments not in the dictionary when parsing began. Rows refer to them
+    // as EMP_MAX_DEPARTMENTS + their index here until the import assigns codes.
+    char new_departments[EMP_MAX_DEPARTMENTS][EMP_MAX_DEPT_LENGTH];
+    int new_department_count;
+};
+
+// The header of employees.dat, department dictionary included: read by
+// emp_checkFormat, grown by emp_addDepartment, and written with every new file.
+static struct EmpFileHeader emp_header = { EMP_FORMAT_MAGIC, EMP_FORMAT_VERSION, sizeof(struct Employee), 1, { "" } };
+
+// employees.dat as a record store keyed by employee_id; deleted employees leave a tombstone for the next add
+static const struct RecordStore emp_store = {
+    EMP_FILENAME, sizeof(struct Employee), offsetof(struct Employee, employee_id), sizeof(int),
+    sizeof(struct EmpFileHeader), &emp_header, EMP_INDEX_FILENAME, EMP_FREE_FILENAME
 };
 
 // --- Function Prototypes ---
@@ -38,20 +180,140 @@ void emp_displayAllEmployees();
 void emp_searchEmployee();
 void emp_updateEmployee();
 void emp_deleteEmployee();
+void emp_payrollReport();
+void emp_raiseDepartment();
+void emp_salaryStatistics();
 
 // File I/O helpers
-int emp_loadEmployees(struct Employee emp_array[]);
+struct Employee *emp_loadEmployees(int *count);
 void emp_saveEmployees(struct Employee emp_array[], int count);
+bool emp_checkFormat();
+int emp_convertLegacy();
+
+// Department dictionary
+void emp_resetDepartments();
+int emp_findDepartment(const char *department);
+int emp_addDepartment(const char *department);
+int emp_internDepartment(const char *department);
+const char *emp_departmentName(int code);
+
+// Date helpers
+bool emp_parseDate(const char *text, int *date);
+void emp_formatDate(int date, char text[EMP_MAX_DATE_LENGTH]);
+int emp_readDate();
+
+// Salary and hire date indexes
+void emp_ensureIndexes();
+void emp_rebuildIndexes();
+void emp_flushIndexes();
+void emp_indexInsert(const struct Employee *emp, long slot);
+void emp_indexRemove(const struct Employee *emp);
+int emp_rangeQuery(const char *index_filename, long long low, long long high, struct Employee results[], int max_results);
+
+// Case-insensitive name search
+bool emp_nameColumnAdd(struct EmpNameColumn *column, const char *name);
+void emp_nameColumnFree(struct EmpNameColumn *column);
+int emp_nameColumnSearch(const struct EmpNameColumn *column, const char *name, int matches[], int max_matches);
+int emp_nameColumnSearchScalar(const struct EmpNameColumn *column, const char *name, int matches[], int max_matches);
+
+// In-place updates
+long emp_departmentRaise(const char *department, float percent);
+bool emp_parsePercent(const char *text, float *percent);
+
+// Payroll report
+struct EmpPayrollTotals *emp_aggregatePayroll(int threads);
+void emp_freePayroll(struct EmpPayrollTotals *totals);
+int emp_runPayroll(int threads);
+
+// Salary statistics
+int emp_topSalaries(int k, int department_code, struct Employee top[]);
+long emp_salaryPercentiles(int department_code, const double percents[], int count, float results[]);
+int emp_runSalaryStats(int k, const char *department);
+
+// CSV import/export
+long emp_importCsv(const char *filename, int threads);
+long emp_exportCsv(const char *filename);
+
+// Benchmark
+int emp_runBench(int records, int operations);
+int emp_runNameBench(int operations);
+int emp_runCsvBench();
+int emp_runPayrollBench(long records);
 
 // --- Main Function for Employee System ---
-int main() {
+int main(int argc, char *argv[]) {
     int choice;
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0) {
+        return emp_runBench(argc > 2 ? atoi(argv[2]) : EMP_MAX_EMPLOYEES, argc > 3 ? atoi(argv[3]) : EMP_BENCH_OPERATIONS);
+    }
+    if (argc > 1 && strcmp(argv[1], "--bench-names") == 0) {
+        return emp_runNameBench(argc > 2 ? atoi(argv[2]) : EMP_BENCH_OPERATIONS);
+    }
+    if (argc > 1 && strcmp(argv[1], "--bench-csv") == 0) {
+        return emp_runCsvBench();
+    }
+    if (argc > 1 && strcmp(argv[1], "--bench-payroll") == 0) {
+        return emp_runPayrollBench(argc > 2 ? atol(argv[2]) : EMP_BENCH_PAYROLL_RECORDS);
+    }
+    if (argc > 1 && strcmp(argv[1], "--convert-format") == 0) {
+        return emp_convertLegacy();
+    }
+    if (argc > 1 && strcmp(argv[1], "--payroll") == 0) {
+        if (!emp_checkFormat()) return 1;
+        return emp_runPayroll(argc > 2 ? atoi(argv[2]) : 0);
+    }
+    if (argc > 3 && strcmp(argv[1], "--raise") == 0) {
+        if (!emp_checkFormat()) return 1;
+        float percent;
+        if (!emp_parsePercent(argv[3], &percent)) {
+            printf("Error: The raise must be a number above -100 and at most %.0f.\n", EMP_MAX_RAISE_PERCENT);
+            return 1;
+        }
+        long count = emp_departmentRaise(argv[2], percent);
+        if (count < 0) return 1;
+        printf("Gave %ld employee(s) in %s a %.2f%% raise.\n", count, argv[2], percent);
+        return 0;
+    }
+    if (argc > 1 && strcmp(argv[1], "--salary-stats") == 0) {
+        if (!emp_checkFormat()) return 1;
+        return emp_runSalaryStats(argc > 2 ? atoi(argv[2]) : EMP_TOP_DEFAULT, argc > 3 ? argv[3] : NULL);
+    }
+    if (argc > 2 && strcmp(argv[1], "--import") == 0) {
+        if (!emp_checkFormat()) return 1;
+        struct timespec start, end;
+        timespec_get(&start, TIME_UTC);
+        long count = emp_importCsv(argv[2], argc > 3 ? atoi(argv[3]) : 0);
+        timespec_get(&end, TIME_UTC);
+        if (count < 0) return 1;
+        printf("Imported %ld employee(s) in %.3f s.\n", count,
+               (double)(end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9);
+        return 0;
+    }
+    if (argc > 2 && strcmp(argv[1], "--export") == 0) {
+        if (!emp_checkFormat()) return 1;
+        long count = emp_exportCsv(argv[2]);
+        if (count >= 0 && strcmp(argv[2], "-") != 0) printf("Exported %ld employee(s) to %s.\n", count, argv[2]);
+        return count >= 0 ? 0 : 1;
+    }
+    if (argc > 1 && strcmp(argv[1], "--defer-sync") == 0) {
+        rs_deferSync(true); // Edits are synced once, on exit
+    } else if (argc > 1) {
+        printf("Usage: %s [--defer-sync] [--convert-format] [--payroll [threads]]\n"
+               "       [--import <file.csv> [threads]] [--export <file.csv>|-] [--raise <department> <percent>]\n"
+               "       [--salary-stats [top-count] [department]]\n"
+               "       [--bench [records] [operations]] [--bench-names [operations]] [--bench-csv]\n"
+               "       [--bench-payroll [records]]\n", argv[0]);
+        return 1;
+    }
+    if (!emp_checkFormat()) return 1;
+    rs_openIndex(&emp_store);
+    emp_ensureIndexes();
     do {
         emp_clearScreen();
         emp_displayMenu();
         printf("Enter your choice: ");
-        while (scanf("%d", &choice) != 1 || choice < 0 || choice > 5) {
-            printf("Invalid choice. Please enter a number between 0 and 5: ");
+        while (scanf("%d", &choice) != 1 || choice < 0 || choice > 8) {
+            printf("Invalid choice. Please enter a number between 0 and 8: ");
             emp_clearInputBuffer();
         }
         emp_clearInputBuffer();
@@ -62,6 +324,9 @@ int main() {
             case 3: emp_searchEmployee(); break;
             case 4: emp_updateEmployee(); break;
             case 5: emp_deleteEmployee(); break;
+            case 6: emp_payrollReport(); break;
+            case 7: emp_raiseDepartment(); break;
+            case 8: emp_salaryStatistics(); break;
             case 0: printf("\nExiting Employee Management System. Goodbye!\n"); break;
             default: printf("\nAn unexpected error occurred.\n"); break;
         }
@@ -70,6 +335,8 @@ int main() {
         }
     } while (choice != 0);
 
+    emp_flushIndexes();
+    rs_flush(&emp_store);
     return 0;
 }
 
@@ -102,31 +369,566 @@ void emp_displayMenu() {
     printf("3. Search Employee\n");
     printf("4. Update Employee Record\n");
     printf("5. Delete Employee Record\n");
+    printf("6. Payroll Report\n");
+    printf("7. Department Raise\n");
+    printf("8. Salary Statistics\n");
     printf("0. Exit\n");
     printf("---------------------------------------\n");
 }
 
 // --- File I/O Helper Functions Implementation ---
-int emp_loadEmployees(struct Employee emp_array[]) {
+// Loads every employee into an array sized from the file, which the caller
+// frees; NULL (and a count of 0) if there are none or memory runs out.
+struct Employee *emp_loadEmployees(int *count) {
+    long slots = 0;
     FILE *fp = fopen(EMP_FILENAME, "rb");
-    if (fp == NULL) return 0;
+    if (fp != NULL) {
+        slots = rs_countSlots(&emp_store, fp);
+        fclose(fp);
+    }
+    *count = 0;
+    if (slots <= 0) return NULL;
+    if (slots > 0x7fffffffL) slots = 0x7fffffffL;
+    struct Employee *employees = (struct Employee *)malloc(slots * sizeof(struct Employee));
+    if (employees == NULL) {
+        printf("Error: Not enough memory to load %ld employee records.\n", slots);
+        return NULL;
+    }
+    *count = rs_loadAll(&emp_store, employees, (int)slots);
+    return employees;
+}
 
-    int count = 0;
-    while (count < EMP_MAX_EMPLOYEES && fread(&emp_array[count], sizeof(struct Employee), 1, fp) == 1) {
+void emp_saveEmployees(struct Employee emp_array[], int count) {
+    rs_saveAll(&emp_store, emp_array, count);
+}
+
+// Returns false, after saying how to convert it, if an existing data file is not
+// in the current format. Otherwise loads its department dictionary (or starts an
+// empty one if there is no file yet: the first add creates it).
+bool emp_checkFormat() {
+    emp_resetDepartments();
+    FILE *fp = fopen(EMP_FILENAME, "rb");
+    if (fp == NULL) return true;
+    struct EmpFileHeader header;
+    bool empty = rs_countRecords(fp, 1) == 0;
+    bool ok = empty ||
+              (fseek(fp, 0, SEEK_SET) == 0 && fread(&header, sizeof(header), 1, fp) == 1 &&
+               memcmp(&header, &emp_header, sizeof(struct EmpFileHeaderV2)) == 0 &&
+               header.department_count >= 1 && header.department_count <= EMP_MAX_DEPARTMENTS);
+    fclose(fp);
+    if (!ok) {
+        printf("%s is not in the current format (version %d). Convert it with --convert-format.\n",
+               EMP_FILENAME, EMP_FORMAT_VERSION);
+    } else if (!empty) {
+        emp_header = header;
+    }
+    return ok;
+}
+
+// Builds the current form of an older record; false if its department does not
+// fit in the dictionary.
+static bool emp_convertRecord(int employee_id, const char *name, const char *department, float salary,
+                              int hire_date, struct Employee *emp) {
+    char dept[EMP_MAX_DEPT_LENGTH];
+    memcpy(dept, department, EMP_MAX_DEPT_LENGTH);
+    dept[EMP_MAX_DEPT_LENGTH - 1] = '\0';
+    int code = emp_addDepartment(dept);
+    if (code < 0) return false;
+    memset(emp, 0, sizeof(struct Employee));
+    emp->employee_id = employee_id;
+    memcpy(emp->name, name, EMP_MAX_NAME_LENGTH);
+    emp->name[EMP_MAX_NAME_LENGTH - 1] = '\0';
+    emp->department_code = (unsigned char)code;
+    emp->salary = salary < EMP_MAX_SALARY ? salary : EMP_MAX_SALARY; // Keeps every salary exportable and importable
+    emp->hire_date = hire_date;
+    return true;
+}
+
+/*
+ * Converts an older data file to the current format, one record at a time, so
+ * files of any size convert:
+ *   version 1 - no header, hire dates as "YYYY-MM-DD" strings. A date that does
+ *               not parse is stored as 0 (unknown).
+ *   version 2 - department names in every record; they become codes into the
+ *               header's dictionary.
+ * The new file is written beside the old one and swapped in when complete; the
+ * old file is kept as EMP_FILENAME ".v<version>.bak".
+ */
+int emp_convertLegacy() {
+    FILE *fp = fopen(EMP_FILENAME, "rb");
+    if (fp == NULL) {
+        printf("Nothing to convert: %s does not exist.\n", EMP_FILENAME);
+        return 1;
+    }
+    struct EmpFileHeaderV2 header;
+    int version = 1;
+    if (fread(&header, sizeof(header), 1, fp) == 1 && memcmp(header.magic, EMP_FORMAT_MAGIC, sizeof(header.magic)) == 0) {
+        version = (int)header.version;
+    }
+    if (version == EMP_FORMAT_VERSION) {
+        printf("%s is already in the current format.\n", EMP_FILENAME);
+        fclose(fp);
+        return 0;
+    }
+    if (version != 1 && (version != 2 || header.record_size != sizeof(struct EmployeeV2))) {
+        printf("Error: %s is format version %d, which this program cannot convert.\n", EMP_FILENAME, version);
+        fclose(fp);
+        return 1;
+    }
+    fseek(fp, version == 1 ? 0 : (long)sizeof(header), SEEK_SET);
+
+    // The header is written again at the end, once the dictionary is complete
+    const char *temp_filename = EMP_FILENAME RS_TEMP_SUFFIX;
+    FILE *out = fopen(temp_filename, "wb");
+    emp_resetDepartments();
+    bool ok = out != NULL && fwrite(&emp_header, sizeof(emp_header), 1, out) == 1;
+    long count = 0, unknown_dates = 0;
+    struct Employee emp;
+    while (ok) {
+        if (version == 1) {
+            struct LegacyEmployee old;
+            if (fread(&old, sizeof(old), 1, fp) != 1) break;
+            if (old.employee_id == RS_TOMBSTONE) continue;
+            int hire_date;
+            old.hire_date[EMP_MAX_DATE_LENGTH - 1] = '\0';
+            if (!emp_parseDate(old.hire_date, &hire_date)) {
+                hire_date = 0;
+                unknown_dates++;
+            }
+            ok = emp_convertRecord(old.employee_id, old.name, old.department, old.salary, hire_date, &emp);
+        } else {
+            struct EmployeeV2 old;
+            if (fread(&old, sizeof(old), 1, fp) != 1) break;
+            if (old.employee_id == RS_TOMBSTONE) continue;
+            ok = emp_convertRecord(old.employee_id, old.name, old.department, old.salary, old.hire_date, &emp);
+        }
+        ok = ok && fwrite(&emp, sizeof(emp), 1, out) == 1;
         count++;
     }
     fclose(fp);
+    if (ok) ok = fseek(out, 0, SEEK_SET) == 0 && fwrite(&emp_header, sizeof(emp_header), 1, out) == 1 && fflush(out) == 0;
+    if (ok) rs_syncFile(out);
+    if (out != NULL && fclose(out) != 0) ok = false;
+
+    char backup[64];
+    snprintf(backup, sizeof(backup), "%s.v%d.bak", EMP_FILENAME, version);
+    if (ok && rename(EMP_FILENAME, backup) != 0) {
+        perror("Error keeping a backup of the old file");
+        ok = false;
+    }
+    if (ok && !rs_replaceFile(temp_filename, EMP_FILENAME)) {
+        rename(backup, EMP_FILENAME);
+        ok = false;
+    }
+    if (!ok) {
+        printf("Error: Could not convert %s; it is unchanged.\n", EMP_FILENAME);
+        remove(temp_filename);
+        return 1;
+    }
+    rs_dropIndex(&emp_store); // Rebuilt for the new file the next time the menu starts
+    emp_rebuildIndexes();
+    printf("Converted %ld employee(s) in %u department(s); the old file is %s.\n",
+           count, emp_header.department_count - 1, backup);
+    if (unknown_dates > 0) printf("%ld hire date(s) could not be read and are now unknown.\n", unknown_dates);
+    return 0;
+}
+
+// --- Department Dictionary Implementation ---
+// Empties the in-memory dictionary (for a new file).
+void emp_resetDepartments() {
+    memset(emp_header.departments, 0, sizeof(emp_header.departments));
+    emp_header.department_count = 1; // Code 0: no department
+}
+
+// Returns the dictionary code of a department, or -1 if it has none yet.
+int emp_findDepartment(const char *department) {
+    for (unsigned int i = 0; i < emp_header.department_count; i++) {
+        if (strncmp(emp_header.departments[i], department, EMP_MAX_DEPT_LENGTH - 1) == 0) return (int)i;
+    }
+    return -1;
+}
+
+// Returns the code of a department, adding it to the in-memory dictionary if
+// needed; -1 (after saying so) if the dictionary is full.
+int emp_addDepartment(const char *department) {
+    int code = emp_findDepartment(department);
+    if (code >= 0) return code;
+    if (emp_header.department_count == EMP_MAX_DEPARTMENTS) {
+        printf("Error: No room for department \"%s\"; at most %d departments are supported.\n",
+               department, EMP_MAX_DEPARTMENTS - 1);
+        return -1;
+    }
+    code = (int)emp_header.department_count++;
+    memcpy(emp_header.departments[code], department, strnlen(department, EMP_MAX_DEPT_LENGTH - 1));
+    return code;
+}
+
+// Like emp_addDepartment, but a new department is also written to the header
+// of the data file at once, before any record uses its code.
+int emp_internDepartment(const char *department) {
+    unsigned int count = emp_header.department_count;
+    int code = emp_addDepartment(department);
+    if (code < 0 || emp_header.department_count == count) return code;
+    FILE *fp = fopen(EMP_FILENAME, "r+b");
+    if (fp == NULL) return code; // No file yet: the first add writes the header
+    bool ok = fwrite(&emp_header, sizeof(emp_header), 1, fp) == 1;
+    if (!rs_finishEdit(fp, ok)) {
+        perror("Error saving department");
+        return -1;
+    }
+    return code;
+}
+
+const char *emp_departmentName(int code) {
+    return code >= 0 && (unsigned int)code < emp_header.department_count ? emp_header.departments[code] : "";
+}
+
+// --- Date Helper Functions Implementation ---
+// Reads 1 to max_digits decimal digits at *cursor into *value and advances past them.
+static bool emp_parseDigits(const char **cursor, int max_digits, int *value) {
+    int digits = 0;
+    *value = 0;
+    while (digits < max_digits && **cursor >= '0' && **cursor <= '9') {
+        *value = *value * 10 + (**cursor - '0');
+        (*cursor)++;
+        digits++;
+    }
+    return digits > 0;
+}
+
+// Parses "YYYY-MM-DD" into YYYYMMDD; false unless it is a real calendar date.
+bool emp_parseDate(const char *text, int *date) {
+    int year, month, day;
+    if (!emp_parseDigits(&text, 4, &year) || *text++ != '-' ||
+        !emp_parseDigits(&text, 2, &month) || *text++ != '-' ||
+        !emp_parseDigits(&text, 2, &day) || *text != '\0') {
+        return false;
+    }
+    static const int days_in_month[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    bool leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+    if (year < 1 || month < 1 || month > 12 || day < 1 ||
+        day > days_in_month[month - 1] + (month == 2 && leap ? 1 : 0)) {
+        return false;
+    }
+    *date = year * 10000 + month * 100 + day;
+    return true;
+}
+
+void emp_formatDate(int date, char text[EMP_MAX_DATE_LENGTH]) {
+    if (date == 0) {
+        snprintf(text, EMP_MAX_DATE_LENGTH, "unknown");
+    } else {
+        snprintf(text, EMP_MAX_DATE_LENGTH, "%04d-%02d-%02d", date / 10000 % 10000, date / 100 % 100, date % 100);
+    }
+}
+
+// Reads a "YYYY-MM-DD" line from the user until it is a valid date.
+int emp_readDate() {
+    char text[EMP_MAX_DATE_LENGTH];
+    int date;
+    while (true) {
+        if (fgets(text, EMP_MAX_DATE_LENGTH, stdin) == NULL) return 0;
+        if (strchr(text, '\n') == NULL) emp_clearInputBuffer(); // Drop the rest of an overlong line
+        text[strcspn(text, "\n")] = 0;
+        if (emp_parseDate(text, &date)) return date;
+        printf("Invalid date. Enter it as YYYY-MM-DD: ");
+    }
+}
+
+// --- Index Helper Functions Implementation ---
+static int emp_compareIndexEntries(const void *a, const void *b) {
+    const struct EmpIndexEntry *lhs = (const struct EmpIndexEntry *)a;
+    const struct EmpIndexEntry *rhs = (const struct EmpIndexEntry *)b;
+    if (lhs->key != rhs->key) return lhs->key < rhs->key ? -1 : 1;
+    return (lhs->employee_id > rhs->employee_id) - (lhs->employee_id < rhs->employee_id);
+}
+
+static long long emp_salaryKey(float salary) {
+    return (long long)(salary * 100.0 + 0.5); // Whole cents; salaries are never negative
+}
+
+static void emp_makeEntries(const struct Employee *emp, long slot, struct EmpIndexEntry *by_salary, struct EmpIndexEntry *by_hired) {
+    memset(by_salary, 0, sizeof(struct EmpIndexEntry));
+    by_salary->key = emp_salaryKey(emp->salary);
+    by_salary->employee_id = emp->employee_id;
+    by_salary->slot = (int)slot;
+    *by_hired = *by_salary;
+    by_hired->key = emp->hire_date;
+}
+
+// Hash of one index entry. Summed over a set of entries it gives a fingerprint
+// that does not depend on their order.
+static unsigned long long emp_entryHash(const struct EmpIndexEntry *entry) {
+    unsigned long long x = (unsigned long long)entry->key * 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (unsigned int)entry->employee_id) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (unsigned int)entry->slot) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+// Rebuilds both indexes if either is missing or does not hold exactly the
+// entries the data file calls for. A count alone would miss a stale salary or
+// hire date left by an edit whose index update never reached the disk, so
+// each index is also compared by the sum of its entry hashes.
+void emp_ensureIndexes() {
+    long live = 0, slot = 0;
+    unsigned long long expected[2] = { 0, 0 };
+    struct EmpIndexEntry entries[2];
+    FILE *fp = fopen(EMP_FILENAME, "rb");
+    struct Employee *block = (struct Employee *)malloc(EMP_PAYROLL_BLOCK * sizeof(struct Employee));
+    if (fp != NULL && block != NULL && fseek(fp, emp_store.header_size, SEEK_SET) == 0) {
+        size_t n;
+        while ((n = fread(block, sizeof(struct Employee), EMP_PAYROLL_BLOCK, fp)) > 0) {
+            for (size_t i = 0; i < n; i++, slot++) {
+                if (block[i].employee_id == RS_TOMBSTONE) continue;
+                emp_makeEntries(&block[i], slot, &entries[0], &entries[1]);
+                expected[0] += emp_entryHash(&entries[0]);
+                expected[1] += emp_entryHash(&entries[1]);
+                live++;
+            }
+        }
+    }
+    free(block);
+    if (fp != NULL) fclose(fp);
+
+    const char *files[] = { EMP_SALARY_INDEX_FILENAME, EMP_HIRED_INDEX_FILENAME };
+    struct EmpIndexEntry *chunk = (struct EmpIndexEntry *)malloc(EMP_PAYROLL_BLOCK * sizeof(struct EmpIndexEntry));
+    bool current = chunk != NULL;
+    for (int f = 0; current && f < 2; f++) {
+        FILE *idx = fopen(files[f], "rb");
+        long count = 0;
+        unsigned long long sum = 0;
+        size_t n;
+        while (idx != NULL && (n = fread(chunk, sizeof(struct EmpIndexEntry), EMP_PAYROLL_BLOCK, idx)) > 0) {
+            for (size_t i = 0; i < n; i++) sum += emp_entryHash(&chunk[i]);
+            count += (long)n;
+        }
+        current = idx != NULL && count == live && sum == expected[f];
+        if (idx != NULL) fclose(idx);
+    }
+    free(chunk);
+    if (!current) emp_rebuildIndexes();
+}
+
+// Builds both indexes from a pass over the data file, which may hold more
+// employees than the menu loads after a CSV import.
+void emp_rebuildIndexes() {
+    long count = 0, slots = 0;
+    FILE *fp = fopen(EMP_FILENAME, "rb");
+    if (fp != NULL) slots = rs_countSlots(&emp_store, fp);
+    struct EmpIndexEntry *by_salary = (struct EmpIndexEntry *)malloc((slots > 0 ? slots : 1) * sizeof(struct EmpIndexEntry));
+    struct EmpIndexEntry *by_hired = (struct EmpIndexEntry *)malloc((slots > 0 ? slots : 1) * sizeof(struct EmpIndexEntry));
+    struct Employee *block = (struct Employee *)malloc(EMP_PAYROLL_BLOCK * sizeof(struct Employee));
+    if (by_salary == NULL || by_hired == NULL || block == NULL) {
+        printf("Error: Not enough memory to rebuild the indexes.\n");
+        slots = 0;
+    }
+    if (fp != NULL && slots > 0 && fseek(fp, emp_store.header_size, SEEK_SET) == 0) {
+        size_t n;
+        long slot = 0;
+        while (slot < slots && (n = fread(block, sizeof(struct Employee), EMP_PAYROLL_BLOCK, fp)) > 0) {
+            for (size_t i = 0; i < n && slot < slots; i++, slot++) {
+                if (block[i].employee_id == RS_TOMBSTONE) continue;
+                emp_makeEntries(&block[i], slot, &by_salary[count], &by_hired[count]);
+                count++;
+            }
+        }
+    }
+    if (fp != NULL) fclose(fp);
+    free(block);
+    qsort(by_salary, count, sizeof(struct EmpIndexEntry), emp_compareIndexEntries);
+    qsort(by_hired, count, sizeof(struct EmpIndexEntry), emp_compareIndexEntries);
+
+    const char *files[] = { EMP_SALARY_INDEX_FILENAME, EMP_HIRED_INDEX_FILENAME };
+    struct EmpIndexEntry *entries[] = { by_salary, by_hired };
+    char temp_filename[FILENAME_MAX];
+    for (int i = 0; i < 2; i++) { // Each index is replaced whole, so a crash leaves the old one or the new one
+        snprintf(temp_filename, sizeof(temp_filename), "%s" RS_TEMP_SUFFIX, files[i]);
+        FILE *idx = fopen(temp_filename, "wb");
+        bool ok = idx != NULL && fwrite(entries[i], sizeof(struct EmpIndexEntry), count, idx) == (size_t)count;
+        if (idx != NULL) {
+            rs_syncFile(idx);
+            if (fclose(idx) != 0) ok = false;
+        }
+        if (!ok || !rs_replaceFile(temp_filename, files[i])) {
+            perror("Error saving index");
+            remove(temp_filename);
+        }
+    }
+    free(by_salary);
+    free(by_hired);
+}
+
+// Syncs the salary and hire date indexes, whose inserts and removals are left
+// to the OS to write; called with rs_flush before exiting.
+void emp_flushIndexes() {
+    const char *files[] = { EMP_SALARY_INDEX_FILENAME, EMP_HIRED_INDEX_FILENAME };
+    for (int i = 0; i < 2; i++) {
+        FILE *idx = fopen(files[i], "r+b");
+        if (idx == NULL) continue;
+        rs_syncFile(idx);
+        fclose(idx);
+    }
+}
+
+void emp_indexInsert(const struct Employee *emp, long slot) {
+    struct EmpIndexEntry by_salary, by_hired;
+    emp_makeEntries(emp, slot, &by_salary, &by_hired);
+    rs_sortedInsert(EMP_SALARY_INDEX_FILENAME, &by_salary, sizeof(struct EmpIndexEntry), emp_compareIndexEntries);
+    rs_sortedInsert(EMP_HIRED_INDEX_FILENAME, &by_hired, sizeof(struct EmpIndexEntry), emp_compareIndexEntries);
+}
+
+// Removes the entries of emp as it is currently stored (its old salary and hire date).
+void emp_indexRemove(const struct Employee *emp) {
+    struct EmpIndexEntry by_salary, by_hired;
+    emp_makeEntries(emp, 0, &by_salary, &by_hired);
+    rs_sortedRemove(EMP_SALARY_INDEX_FILENAME, &by_salary, sizeof(struct EmpIndexEntry), emp_compareIndexEntries);
+    rs_sortedRemove(EMP_HIRED_INDEX_FILENAME, &by_hired, sizeof(struct EmpIndexEntry), emp_compareIndexEntries);
+}
+
+// Collects the employees whose index key lies in [low, high], in key order, by
+// binary search to the first match and a sequential read of the rest; returns
+// how many were found (at most max_results).
+int emp_rangeQuery(const char *index_filename, long long low, long long high, struct Employee results[], int max_results) {
+    FILE *idx = fopen(index_filename, "rb");
+    FILE *fp = fopen(EMP_FILENAME, "rb");
+    int count = 0;
+    if (idx != NULL && fp != NULL) {
+        long entry_count = rs_countRecords(idx, sizeof(struct EmpIndexEntry));
+        struct EmpIndexEntry entry;
+        memset(&entry, 0, sizeof(entry));
+        entry.key = low; // employee_id 0 sorts before every real entry with this key
+        long pos = rs_sortedLowerBound(idx, &entry, sizeof(struct EmpIndexEntry), entry_count, emp_compareIndexEntries);
+        fseek(idx, pos * (long)sizeof(struct EmpIndexEntry), SEEK_SET);
+        while (count < max_results && fread(&entry, sizeof(struct EmpIndexEntry), 1, idx) == 1 && entry.key <= high) {
+            // Skip an entry the data file no longer agrees with (the index is rebuilt at the next start)
+            if (rs_readAt(&emp_store, fp, entry.slot, &results[count]) && results[count].employee_id == entry.employee_id) {
+                count++;
+            }
+        }
+    }
+    if (idx != NULL) fclose(idx);
+    if (fp != NULL) fclose(fp);
     return count;
 }
 
-void emp_saveEmployees(struct Employee emp_array[], int count) {
-    FILE *fp = fopen(EMP_FILENAME, "wb");
-    if (fp == NULL) {
-        perror("Error opening file for saving employees");
-        return;
+// --- Name Search Implementation ---
+// Appends a folded copy of name as the next row; false if out of memory.
+bool emp_nameColumnAdd(struct EmpNameColumn *column, const char *name) {
+    size_t name_length = strnlen(name, EMP_MAX_NAME_LENGTH - 1);
+    if (column->count == column->row_capacity) {
+        int rows = column->row_capacity > 0 ? column->row_capacity * 2 : 1024;
+        int *starts = (int *)realloc(column->starts, rows * sizeof(int));
+        if (starts == NULL) return false;
+        column->starts = starts;
+        column->row_capacity = rows;
     }
-    fwrite(emp_array, sizeof(struct Employee), count, fp);
-    fclose(fp);
+    size_t needed = column->length + name_length + 1 + EMP_NAME_COLUMN_PADDING;
+    if (needed > column->capacity) {
+        size_t bytes = column->capacity > 0 ? column->capacity * 2 : 64 * 1024;
+        while (bytes < needed) bytes *= 2;
+        char *text = (char *)realloc(column->text, bytes);
+        if (text == NULL) return false;
+        column->text = text;
+        column->capacity = bytes;
+    }
+    char *row = column->text + column->length;
+    for (size_t i = 0; i < name_length; i++) {
+        row[i] = (char)tolower((unsigned char)name[i]);
+    }
+    memset(row + name_length, 0, 1 + EMP_NAME_COLUMN_PADDING);
+    column->starts[column->count++] = (int)column->length;
+    column->length += name_length + 1;
+    return true;
+}
+
+void emp_nameColumnFree(struct EmpNameColumn *column) {
+    free(column->text);
+    free(column->starts);
+    memset(column, 0, sizeof(struct EmpNameColumn));
+}
+
+// Folds name into needle and returns its length.
+static size_t emp_foldNeedle(const char *name, char needle[EMP_MAX_NAME_LENGTH]) {
+    size_t length = 0;
+    while (name[length] != '\0' && length < EMP_MAX_NAME_LENGTH - 1) {
+        needle[length] = (char)tolower((unsigned char)name[length]);
+        length++;
+    }
+    needle[length] = '\0';
+    return length;
+}
+
+// Every row matches an empty name, as with strstr.
+static int emp_allRows(const struct EmpNameColumn *column, int matches[], int max_matches) {
+    int count = 0;
+    while (count < column->count && count < max_matches) {
+        matches[count] = count;
+        count++;
+    }
+    return count;
+}
+
+// Row-at-a-time search of the folded column; the portable fallback and the
+// baseline the vector search is benchmarked against.
+int emp_nameColumnSearchScalar(const struct EmpNameColumn *column, const char *name, int matches[], int max_matches) {
+    char needle[EMP_MAX_NAME_LENGTH];
+    if (emp_foldNeedle(name, needle) == 0) return emp_allRows(column, matches, max_matches);
+    int count = 0;
+    for (int row = 0; row < column->count && count < max_matches; row++) {
+        if (strstr(column->text + column->starts[row], needle) != NULL) {
+            matches[count++] = row;
+        }
+    }
+    return count;
+}
+
+#ifdef EMP_HAVE_SSE2
+static int emp_lowestBit(unsigned int mask) {
+    #ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward(&index, mask);
+        return (int)index;
+    #else
+        return __builtin_ctz(mask);
+    #endif
+}
+#endif
+
+/*
+ * Fills matches with the rows (in load order) whose name contains name,
+ * ignoring case, and returns how many there are (at most max_matches).
+ *
+ * With SSE2 the whole column is scanned 16 positions at a time: a position is a
+ * candidate only if it holds the needle's first character and the position
+ * length - 1 bytes on holds its last, and only candidates are compared in full.
+ */
+int emp_nameColumnSearch(const struct EmpNameColumn *column, const char *name, int matches[], int max_matches) {
+#ifdef EMP_HAVE_SSE2
+    char needle[EMP_MAX_NAME_LENGTH];
+    size_t length = emp_foldNeedle(name, needle);
+    if (length == 0) return emp_allRows(column, matches, max_matches);
+
+    const char *text = column->text;
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i last = _mm_set1_epi8(needle[length - 1]);
+    int count = 0, row = 0;
+    for (size_t i = 0; i < column->length && count < max_matches; i += 16) {
+        __m128i block_first = _mm_loadu_si128((const __m128i *)(text + i));
+        __m128i block_last = _mm_loadu_si128((const __m128i *)(text + i + length - 1));
+        unsigned int mask = (unsigned int)_mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(block_first, first), _mm_cmpeq_epi8(block_last, last)));
+        while (mask != 0 && count < max_matches) {
+            size_t pos = i + emp_lowestBit(mask);
+            mask &= mask - 1;
+            if (memcmp(text + pos + 1, needle + 1, length - 1) != 0) continue;
+            while (row + 1 < column->count && (size_t)column->starts[row + 1] <= pos) row++;
+            if (count == 0 || matches[count - 1] != row) matches[count++] = row; // Once per name
+        }
+    }
+    return count;
+#else
+    return emp_nameColumnSearchScalar(column, name, matches, max_matches);
+#endif
 }
 
 // --- CRUD Operations Implementation ---
@@ -134,8 +936,8 @@ void emp_addEmployee() {
     emp_clearScreen();
     printf("--- Add New Employee ---\n");
     struct Employee new_emp;
-    struct Employee existing_employees[EMP_MAX_EMPLOYEES];
-    int current_count = emp_loadEmployees(existing_employees);
+    memset(&new_emp, 0, sizeof(new_emp));
+    struct Employee existing;
 
     printf("Enter Employee ID: ");
     while (scanf("%d", &new_emp.employee_id) != 1 || new_emp.employee_id <= 0) {
@@ -144,47 +946,45 @@ void emp_addEmployee() {
     }
     emp_clearInputBuffer();
 
-    for (int i = 0; i < current_count; i++) {
-        if (existing_employees[i].employee_id == new_emp.employee_id) {
-            printf("Error: Employee with ID %d already exists.\n", new_emp.employee_id);
-            return;
-        }
+    if (rs_find(&emp_store, new_emp.employee_id, &existing)) {
+        printf("Error: Employee with ID %d already exists.\n", new_emp.employee_id);
+        return;
     }
 
     printf("Enter Name (max %d chars): ", EMP_MAX_NAME_LENGTH - 1);
     fgets(new_emp.name, EMP_MAX_NAME_LENGTH, stdin);
     new_emp.name[strcspn(new_emp.name, "\n")] = 0;
 
+    char department[EMP_MAX_DEPT_LENGTH];
     printf("Enter Department (max %d chars): ", EMP_MAX_DEPT_LENGTH - 1);
-    fgets(new_emp.department, EMP_MAX_DEPT_LENGTH, stdin);
-    new_emp.department[strcspn(new_emp.department, "\n")] = 0;
+    fgets(department, EMP_MAX_DEPT_LENGTH, stdin);
+    department[strcspn(department, "\n")] = 0;
 
     printf("Enter Salary (e.g., 50000.00): ");
-    while (scanf("%f", &new_emp.salary) != 1 || new_emp.salary < 0.0) {
-        printf("Invalid Salary. Enter 0 or a positive number: ");
+    while (scanf("%f", &new_emp.salary) != 1 || !(new_emp.salary >= 0.0f && new_emp.salary <= EMP_MAX_SALARY)) {
+        printf("Invalid Salary. Enter a number from 0 to %.0f: ", EMP_MAX_SALARY);
         emp_clearInputBuffer();
     }
     emp_clearInputBuffer();
 
     printf("Enter Hire Date (YYYY-MM-DD): ");
-    fgets(new_emp.hire_date, EMP_MAX_DATE_LENGTH, stdin);
-    new_emp.hire_date[strcspn(new_emp.hire_date, "\n")] = 0;
+    new_emp.hire_date = emp_readDate();
 
-    if (current_count < EMP_MAX_EMPLOYEES) {
-        existing_employees[current_count] = new_emp;
-        current_count++;
-        emp_saveEmployees(existing_employees, current_count);
+    int code = emp_internDepartment(department);
+    if (code < 0) return;
+    new_emp.department_code = (unsigned char)code;
+    long slot = rs_append(&emp_store, &new_emp);
+    if (slot >= 0) {
+        emp_indexInsert(&new_emp, slot);
         printf("\nEmployee added successfully!\n");
-    } else {
-        printf("\nSystem capacity reached. Cannot add more employees.\n");
     }
 }
 
 void emp_displayAllEmployees() {
     emp_clearScreen();
     printf("--- All Employees ---\n");
-    struct Employee employees[EMP_MAX_EMPLOYEES];
-    int count = emp_loadEmployees(employees);
+    int count;
+    struct Employee *employees = emp_loadEmployees(&count);
 
     if (count == 0) {
         printf("\nNo employee records found.\n");
@@ -194,14 +994,17 @@ void emp_displayAllEmployees() {
     printf("---------------------------------------------------------------------------------------------------\n");
     printf("%-8s %-*s %-*s %-15s %-12s\n", "ID", EMP_MAX_NAME_LENGTH, "Name", EMP_MAX_DEPT_LENGTH, "Department", "Salary", "Hire Date");
     printf("---------------------------------------------------------------------------------------------------\n");
+    char hire_date[EMP_MAX_DATE_LENGTH];
     for (int i = 0; i < count; i++) {
+        emp_formatDate(employees[i].hire_date, hire_date);
         printf("%-8d %-*s %-*s %-15.2f %-12s\n",
                employees[i].employee_id,
                EMP_MAX_NAME_LENGTH, employees[i].name,
-               EMP_MAX_DEPT_LENGTH, employees[i].department,
-               employees[i].salary, employees[i].hire_date);
+               EMP_MAX_DEPT_LENGTH, emp_departmentName(employees[i].department_code),
+               employees[i].salary, hire_date);
     }
     printf("---------------------------------------------------------------------------------------------------\n");
+    free(employees);
 }
 
 void emp_searchEmployee() {
@@ -209,16 +1012,58 @@ void emp_searchEmployee() {
     printf("--- Search Employee ---\n");
     int choice;
     bool found = false;
+    char hire_date[EMP_MAX_DATE_LENGTH];
 
-    printf("Search by:\n1. Employee ID\n2. Name\nEnter choice: ");
-    while (scanf("%d", &choice) != 1 || (choice != 1 && choice != 2)) {
-        printf("Invalid choice. Enter 1 or 2: ");
+    printf("Search by:\n1. Employee ID\n2. Name\n3. Salary range\n4. Hire date range\nEnter choice: ");
+    while (scanf("%d", &choice) != 1 || choice < 1 || choice > 4) {
+        printf("Invalid choice. Enter 1 to 4: ");
         emp_clearInputBuffer();
     }
     emp_clearInputBuffer();
 
-    struct Employee employees[EMP_MAX_EMPLOYEES];
-    int count = emp_loadEmployees(employees);
+    if (choice == 3 || choice == 4) { // Range queries go through the sorted indexes
+        long long low, high;
+        if (choice == 3) {
+            float min_salary, max_salary;
+            printf("Enter minimum and maximum salary (e.g., 40000 60000): ");
+            while (scanf("%f %f", &min_salary, &max_salary) != 2 || min_salary < 0.0 || max_salary < min_salary) {
+                printf("Invalid range. Enter two salaries, the smaller first: ");
+                emp_clearInputBuffer();
+            }
+            emp_clearInputBuffer();
+            low = emp_salaryKey(min_salary);
+            high = emp_salaryKey(max_salary);
+        } else {
+            int from, to;
+            printf("Enter first hire date (YYYY-MM-DD): ");
+            from = emp_readDate();
+            printf("Enter last hire date (YYYY-MM-DD): ");
+            to = emp_readDate();
+            low = from < to ? from : to;
+            high = from < to ? to : from;
+        }
+        static struct Employee matches[EMP_MAX_EMPLOYEES];
+        int match_count = emp_rangeQuery(choice == 3 ? EMP_SALARY_INDEX_FILENAME : EMP_HIRED_INDEX_FILENAME,
+                                         low, high, matches, EMP_MAX_EMPLOYEES);
+        if (match_count == 0) {
+            printf("\nNo employees in that range.\n");
+            return;
+        }
+        printf("\n%d employee(s) found:\n", match_count);
+        printf("---------------------------------------------------------------------------------------------------\n");
+        printf("%-8s %-*s %-*s %-15s %-12s\n", "ID", EMP_MAX_NAME_LENGTH, "Name", EMP_MAX_DEPT_LENGTH, "Department", "Salary", "Hire Date");
+        printf("---------------------------------------------------------------------------------------------------\n");
+        for (int i = 0; i < match_count; i++) {
+            emp_formatDate(matches[i].hire_date, hire_date);
+            printf("%-8d %-*s %-*s %-15.2f %-12s\n",
+                   matches[i].employee_id,
+                   EMP_MAX_NAME_LENGTH, matches[i].name,
+                   EMP_MAX_DEPT_LENGTH, emp_departmentName(matches[i].department_code),
+                   matches[i].salary, hire_date);
+        }
+        printf("---------------------------------------------------------------------------------------------------\n");
+        return;
+    }
 
     if (choice == 1) {
         int search_id;
@@ -228,32 +1073,49 @@ void emp_searchEmployee() {
             emp_clearInputBuffer();
         }
         emp_clearInputBuffer();
-        for (int i = 0; i < count; i++) {
-            if (employees[i].employee_id == search_id) {
-                printf("\nEmployee Found:\n");
-                printf("ID: %d\nName: %s\nDepartment: %s\nSalary: %.2f\nHire Date: %s\n",
-                       employees[i].employee_id, employees[i].name, employees[i].department,
-                       employees[i].salary, employees[i].hire_date);
-                found = true;
-                break;
-            }
+        struct Employee emp;
+        if (rs_find(&emp_store, search_id, &emp)) {
+            emp_formatDate(emp.hire_date, hire_date);
+            printf("\nEmployee Found:\n");
+            printf("ID: %d\nName: %s\nDepartment: %s\nSalary: %.2f\nHire Date: %s\n",
+                   emp.employee_id, emp.name, emp_departmentName(emp.department_code), emp.salary, hire_date);
+            found = true;
         }
     } else { // Search by Name
         char search_name[EMP_MAX_NAME_LENGTH];
         printf("Enter Name to search (partial or full): ");
         fgets(search_name, EMP_MAX_NAME_LENGTH, stdin);
         search_name[strcspn(search_name, "\n")] = 0;
-        for (int i = 0; i < count; i++) {
-            // Case-insensitive search
-            if (strstr(employees[i].name, search_name) != NULL) {
-                printf("\nEmployee Found:\n");
-                printf("ID: %d\nName: %s\nDepartment: %s\nSalary: %.2f\nHire Date: %s\n",
-                       employees[i].employee_id, employees[i].name, employees[i].department,
-                       employees[i].salary, employees[i].hire_date);
-                found = true;
-                // Don't break, show all matches
+
+        int count;
+        struct Employee *employees = emp_loadEmployees(&count);
+        struct EmpNameColumn names;
+        memset(&names, 0, sizeof(names));
+        int *matches = (int *)malloc((count > 0 ? count : 1) * sizeof(int));
+        for (int i = 0; matches != NULL && i < count; i++) {
+            if (!emp_nameColumnAdd(&names, employees[i].name)) {
+                free(matches);
+                matches = NULL;
             }
         }
+        if (matches == NULL) {
+            printf("Error: Not enough memory to search names.\n");
+            emp_nameColumnFree(&names);
+            free(employees);
+            return;
+        }
+        int match_count = emp_nameColumnSearch(&names, search_name, matches, count);
+        emp_nameColumnFree(&names);
+        for (int m = 0; m < match_count; m++) { // Show all matches, case-insensitively
+            struct Employee *emp = &employees[matches[m]];
+            emp_formatDate(emp->hire_date, hire_date);
+            printf("\nEmployee Found:\n");
+            printf("ID: %d\nName: %s\nDepartment: %s\nSalary: %.2f\nHire Date: %s\n",
+                   emp->employee_id, emp->name, emp_departmentName(emp->department_code), emp->salary, hire_date);
+            found = true;
+        }
+        free(matches);
+        free(employees);
     }
 
     if (!found) {
@@ -261,11 +1123,12 @@ void emp_searchEmployee() {
     }
 }
 
+// Changes one field (or every field) of an employee. A single field is written
+// in place at its offset in the record; the rest of the record is not touched.
 void emp_updateEmployee() {
     emp_clearScreen();
     printf("--- Update Employee Record ---\n");
     int update_id;
-    bool found = false;
 
     printf("Enter Employee ID to update: ");
     while (scanf("%d", &update_id) != 1 || update_id <= 0) {
@@ -274,54 +1137,78 @@ void emp_updateEmployee() {
     }
     emp_clearInputBuffer();
 
-    struct Employee employees[EMP_MAX_EMPLOYEES];
-    int count = emp_loadEmployees(employees);
-
-    for (int i = 0; i < count; i++) {
-        if (employees[i].employee_id == update_id) {
-            found = true;
-            printf("\nEmployee found. Enter new details:\n");
-
-            printf("Current Name: %s\n", employees[i].name);
-            printf("Enter New Name (max %d chars): ", EMP_MAX_NAME_LENGTH - 1);
-            fgets(employees[i].name, EMP_MAX_NAME_LENGTH, stdin);
-            employees[i].name[strcspn(employees[i].name, "\n")] = 0;
-
-            printf("Current Department: %s\n", employees[i].department);
-            printf("Enter New Department (max %d chars): ", EMP_MAX_DEPT_LENGTH - 1);
-            fgets(employees[i].department, EMP_MAX_DEPT_LENGTH, stdin);
-            employees[i].department[strcspn(employees[i].department, "\n")] = 0;
-
-            printf("Current Salary: %.2f\n", employees[i].salary);
-            printf("Enter New Salary (0.0 or more): ");
-            while (scanf("%f", &employees[i].salary) != 1 || employees[i].salary < 0.0) {
-                printf("Invalid Salary. Enter 0 or a positive number: ");
-                emp_clearInputBuffer();
-            }
-            emp_clearInputBuffer();
+    struct Employee before;
+    if (!rs_find(&emp_store, update_id, &before)) {
+        printf("\nEmployee with ID %d not found for update.\n", update_id);
+        return;
+    }
+    struct Employee after = before;
+    char hire_date[EMP_MAX_DATE_LENGTH];
+    emp_formatDate(before.hire_date, hire_date);
+    printf("\nEmployee found:\nName: %s\nDepartment: %s\nSalary: %.2f\nHire Date: %s\n",
+           before.name, emp_departmentName(before.department_code), before.salary, hire_date);
 
-            printf("Current Hire Date: %s\n", employees[i].hire_date);
-            printf("Enter New Hire Date (YYYY-MM-DD): ");
-            fgets(employees[i].hire_date, EMP_MAX_DATE_LENGTH, stdin);
-            employees[i].hire_date[strcspn(employees[i].hire_date, "\n")] = 0;
+    int choice;
+    printf("\nUpdate:\n1. Name\n2. Department\n3. Salary\n4. Hire Date\n5. All fields\nEnter choice: ");
+    while (scanf("%d", &choice) != 1 || choice < 1 || choice > 5) {
+        printf("Invalid choice. Enter 1 to 5: ");
+        emp_clearInputBuffer();
+    }
+    emp_clearInputBuffer();
 
-            emp_saveEmployees(employees, count);
-            printf("\nEmployee record updated successfully!\n");
-            break;
+    if (choice == 1 || choice == 5) {
+        printf("Enter New Name (max %d chars): ", EMP_MAX_NAME_LENGTH - 1);
+        memset(after.name, 0, EMP_MAX_NAME_LENGTH);
+        fgets(after.name, EMP_MAX_NAME_LENGTH, stdin);
+        after.name[strcspn(after.name, "\n")] = 0;
+    }
+    if (choice == 2 || choice == 5) {
+        char department[EMP_MAX_DEPT_LENGTH];
+        printf("Enter New Department (max %d chars): ", EMP_MAX_DEPT_LENGTH - 1);
+        fgets(department, EMP_MAX_DEPT_LENGTH, stdin);
+        department[strcspn(department, "\n")] = 0;
+        int code = emp_internDepartment(department);
+        if (code < 0) return;
+        after.department_code = (unsigned char)code;
+    }
+    if (choice == 3 || choice == 5) {
+        printf("Enter New Salary (0.0 or more): ");
+        while (scanf("%f", &after.salary) != 1 || !(after.salary >= 0.0f && after.salary <= EMP_MAX_SALARY)) {
+            printf("Invalid Salary. Enter a number from 0 to %.0f: ", EMP_MAX_SALARY);
+            emp_clearInputBuffer();
         }
+        emp_clearInputBuffer();
+    }
+    if (choice == 4 || choice == 5) {
+        printf("Enter New Hire Date (YYYY-MM-DD): ");
+        after.hire_date = emp_readDate();
     }
 
-    if (!found) {
-        printf("\nEmployee with ID %d not found for update.\n", update_id);
+    static const size_t field_offsets[] = { offsetof(struct Employee, name), offsetof(struct Employee, department_code),
+                                            offsetof(struct Employee, salary), offsetof(struct Employee, hire_date) };
+    static const size_t field_sizes[] = { EMP_MAX_NAME_LENGTH, sizeof(unsigned char), sizeof(float), sizeof(int) };
+    long slot;
+    if (choice == 5) {
+        slot = rs_update(&emp_store, &after);
+    } else {
+        size_t offset = field_offsets[choice - 1];
+        slot = rs_updateField(&emp_store, update_id, offset, field_sizes[choice - 1], (const char *)&after + offset);
+    }
+    if (slot < 0) {
+        printf("\nError: Could not update employee %d.\n", update_id);
+        return;
     }
+    if (after.salary != before.salary || after.hire_date != before.hire_date) {
+        emp_indexRemove(&before);
+        emp_indexInsert(&after, slot);
+    }
+    printf("\nEmployee record updated successfully!\n");
 }
 
 void emp_deleteEmployee() {
     emp_clearScreen();
     printf("--- Delete Employee Record ---\n");
     int delete_id;
-    bool found = false;
-    int delete_index = -1;
 
     printf("Enter Employee ID to delete: ");
     while (scanf("%d", &delete_id) != 1 || delete_id <= 0) {
@@ -330,27 +1217,1029 @@ void emp_deleteEmployee() {
     }
     emp_clearInputBuffer();
 
-    struct Employee employees[EMP_MAX_EMPLOYEES];
-    int count = emp_loadEmployees(employees);
+    struct Employee emp;
+    if (!rs_find(&emp_store, delete_id, &emp) || !rs_delete(&emp_store, delete_id)) {
+        printf("\nEmployee with ID %d not found for deletion.\n", delete_id);
+        return;
+    }
+    emp_indexRemove(&emp);
+    printf("\nEmployee with ID %d deleted successfully!\n", delete_id);
+}
 
-    for (int i = 0; i < count; i++) {
-        if (employees[i].employee_id == delete_id) {
-            found = true;
-            delete_index = i;
-            break;
+void emp_payrollReport() {
+    emp_clearScreen();
+    emp_runPayroll(0);
+}
+
+void emp_raiseDepartment() {
+    emp_clearScreen();
+    printf("--- Department Raise ---\n");
+    char department[EMP_MAX_DEPT_LENGTH];
+    float percent;
+    printf("Enter Department (exact name): ");
+    fgets(department, EMP_MAX_DEPT_LENGTH, stdin);
+    department[strcspn(department, "\n")] = 0;
+    printf("Enter raise in percent (e.g., 3.5): ");
+    while (scanf("%f", &percent) != 1 || !(percent > -100.0f && percent <= EMP_MAX_RAISE_PERCENT)) {
+        printf("Invalid raise. Enter a number above -100 and at most %.0f: ", EMP_MAX_RAISE_PERCENT);
+        emp_clearInputBuffer();
+    }
+    emp_clearInputBuffer();
+
+    long count = emp_departmentRaise(department, percent);
+    if (count == 0) {
+        printf("\nNo employees in department '%s'.\n", department);
+    } else if (count > 0) {
+        printf("\nGave %ld employee(s) a %.2f%% raise.\n", count, percent);
+    }
+}
+
+void emp_salaryStatistics() {
+    emp_clearScreen();
+    printf("--- Salary Statistics ---\n");
+    char department[EMP_MAX_DEPT_LENGTH];
+    int k;
+    printf("Enter Department (exact name, or leave empty for everyone): ");
+    fgets(department, EMP_MAX_DEPT_LENGTH, stdin);
+    department[strcspn(department, "\n")] = 0;
+    printf("How many top earners to list? ");
+    while (scanf("%d", &k) != 1 || k < 0) {
+        printf("Invalid count. Enter 0 or a positive number: ");
+        emp_clearInputBuffer();
+    }
+    emp_clearInputBuffer();
+    printf("\n");
+    emp_runSalaryStats(k, department[0] != '\0' ? department : NULL);
+}
+
+// --- In-Place Update Implementation ---
+// Parses a raise such as 3.5 or -10; it must be above -100 and at most EMP_MAX_RAISE_PERCENT.
+bool emp_parsePercent(const char *text, float *percent) {
+    char *end;
+    double value = strtod(text, &end);
+    if (end == text || *end != '\0' || !isfinite(value)) return false;
+    if (!(value > -100.0 && value <= EMP_MAX_RAISE_PERCENT)) return false;
+    *percent = (float)value;
+    return true;
+}
+
+/*
+ * Raises the salary of everyone in department by percent (rounded to cents)
+ * in one pass over the file: records are read a block at a time and only the
+ * salary field of each matching record is written back, in place. A raised
+ * salary is capped at EMP_MAX_SALARY. The indexes are rebuilt afterwards if
+ * anything changed. Returns how many employees were raised, or -1 on error.
+ */
+long emp_departmentRaise(const char *department, float percent) {
+    int code = emp_findDepartment(department);
+    if (code < 0) return 0; // Nobody has ever been in it
+    FILE *fp = fopen(EMP_FILENAME, "r+b");
+    if (fp == NULL) return 0; // No employees yet
+    struct Employee *block = (struct Employee *)malloc(EMP_PAYROLL_BLOCK * sizeof(struct Employee));
+    bool ok = block != NULL && fseek(fp, emp_store.header_size, SEEK_SET) == 0;
+    long raised = 0, slot = 0;
+    size_t n;
+    while (ok && (n = fread(block, sizeof(struct Employee), EMP_PAYROLL_BLOCK, fp)) > 0) {
+        bool wrote = false;
+        for (size_t i = 0; ok && i < n; i++) {
+            struct Employee *emp = &block[i];
+            if (emp->employee_id == RS_TOMBSTONE || emp->department_code != code) continue;
+            float salary = (float)((long long)(emp->salary * (100.0 + percent) + 0.5) / 100.0);
+            if (salary > EMP_MAX_SALARY) salary = EMP_MAX_SALARY; // Still exportable and importable
+            ok = fseek(fp, rs_slotOffset(&emp_store, slot + (long)i) + (long)offsetof(struct Employee, salary), SEEK_SET) == 0 &&
+                 fwrite(&salary, sizeof(float), 1, fp) == 1;
+            if (ok) raised++;
+            wrote = true;
         }
+        slot += (long)n;
+        if (ok && wrote) ok = fseek(fp, rs_slotOffset(&emp_store, slot), SEEK_SET) == 0; // Back to reading
+    }
+    free(block);
+    if (!rs_finishEdit(fp, ok)) {
+        perror("Error updating salaries");
+        return -1;
     }
+    if (raised > 0) emp_rebuildIndexes();
+    return raised;
+}
 
-    if (!found) {
-        printf("\nEmployee with ID %d not found for deletion.\n", delete_id);
+// --- Payroll Report Implementation ---
+// Adds count salaries totalling total to stats; false if out of memory.
+static bool emp_deptAddSalaries(struct EmpDeptStats *stats, const float salaries[], long count, double total) {
+    if (stats->headcount + count > stats->salary_capacity) {
+        long capacity = stats->salary_capacity > 0 ? stats->salary_capacity * 2 : 256;
+        while (capacity < stats->headcount + count) capacity *= 2;
+        float *grown = (float *)realloc(stats->salaries, capacity * sizeof(float));
+        if (grown == NULL) return false;
+        stats->salaries = grown;
+        stats->salary_capacity = capacity;
+    }
+    for (long i = 0; i < count; i++) {
+        if (stats->headcount + i == 0 || salaries[i] < stats->min_salary) stats->min_salary = salaries[i];
+        if (stats->headcount + i == 0 || salaries[i] > stats->max_salary) stats->max_salary = salaries[i];
+    }
+    memcpy(stats->salaries + stats->headcount, salaries, count * sizeof(float));
+    stats->headcount += count;
+    stats->total_salary += total;
+    return true;
+}
+
+// Folds one stored employee into totals; false if out of memory.
+static bool emp_payrollAdd(struct EmpPayrollTotals *totals, const struct Employee *emp) {
+    int code = emp->department_code < EMP_MAX_DEPARTMENTS ? emp->department_code : 0;
+    if (!emp_deptAddSalaries(&totals->departments[code], &emp->salary, 1, emp->salary)) return false;
+
+    int year = emp->hire_date / 10000;
+    if (year < 0 || year >= EMP_COHORT_YEARS) year = 0;
+    totals->cohort_count[year]++;
+    totals->cohort_salary[year] += emp->salary;
+    totals->employees++;
+    return true;
+}
+
+// Reads its slot range in blocks with its own FILE and aggregates it into part->totals.
+static void emp_payrollWorker(struct EmpPayrollPart *part) {
+    part->ok = false;
+    FILE *fp = fopen(EMP_FILENAME, "rb");
+    struct Employee *block = (struct Employee *)malloc(EMP_PAYROLL_BLOCK * sizeof(struct Employee));
+    if (fp != NULL && block != NULL && fseek(fp, rs_slotOffset(&emp_store, part->first_slot), SEEK_SET) == 0) {
+        part->ok = true;
+        long slot = part->first_slot;
+        while (part->ok && slot < part->end_slot) {
+            long want = part->end_slot - slot < EMP_PAYROLL_BLOCK ? part->end_slot - slot : EMP_PAYROLL_BLOCK;
+            size_t n = fread(block, sizeof(struct Employee), want, fp);
+            if (n == 0) break;
+            for (size_t i = 0; i < n && part->ok; i++) {
+                if (block[i].employee_id != RS_TOMBSTONE) part->ok = emp_payrollAdd(&part->totals, &block[i]);
+            }
+            slot += n;
+        }
+    }
+    free(block);
+    if (fp != NULL) fclose(fp);
+}
+
+// Merges from into into, leaving from empty; false if out of memory.
+static bool emp_mergePayroll(struct EmpPayrollTotals *into, struct EmpPayrollTotals *from) {
+    for (int code = 0; code < EMP_MAX_DEPARTMENTS; code++) {
+        struct EmpDeptStats *source = &from->departments[code];
+        struct EmpDeptStats *stats = &into->departments[code];
+        if (source->headcount == 0) continue;
+        float min_salary = stats->headcount > 0 && stats->min_salary < source->min_salary ? stats->min_salary : source->min_salary;
+        float max_salary = stats->headcount > 0 && stats->max_salary > source->max_salary ? stats->max_salary : source->max_salary;
+        if (!emp_deptAddSalaries(stats, source->salaries, source->headcount, source->total_salary)) return false;
+        stats->min_salary = min_salary;
+        stats->max_salary = max_salary;
+    }
+    for (int year = 0; year < EMP_COHORT_YEARS; year++) {
+        into->cohort_count[year] += from->cohort_count[year];
+        into->cohort_salary[year] += from->cohort_salary[year];
+    }
+    into->employees += from->employees;
+    return true;
+}
+
+static void emp_freeDepartments(struct EmpDeptStats departments[]) {
+    for (int code = 0; code < EMP_MAX_DEPARTMENTS; code++) {
+        free(departments[code].salaries);
+        departments[code].salaries = NULL;
+    }
+}
+
+void emp_freePayroll(struct EmpPayrollTotals *totals) {
+    if (totals == NULL) return;
+    emp_freeDepartments(totals->departments);
+    free(totals);
+}
+
+/*
+ * Splits the data file into one contiguous slot range per thread, aggregates
+ * each range into thread-local totals indexed by department code, and merges
+ * them.
+ * threads <= 0 uses one per core. Returns NULL if the file cannot be read or
+ * memory runs out; the caller frees the result with emp_freePayroll.
+ */
+struct EmpPayrollTotals *emp_aggregatePayroll(int threads) {
+    if (threads <= 0) threads = (int)std::thread::hardware_concurrency();
+    if (threads <= 0) threads = 1;
+    if (threads > EMP_MAX_THREADS) threads = EMP_MAX_THREADS;
+
+    long slots = 0;
+    FILE *fp = fopen(EMP_FILENAME, "rb");
+    if (fp != NULL) {
+        slots = rs_countSlots(&emp_store, fp);
+        fclose(fp);
+    }
+    if (slots < threads) threads = slots > 0 ? (int)slots : 1;
+
+    struct EmpPayrollPart *parts[EMP_MAX_THREADS];
+    std::thread workers[EMP_MAX_THREADS];
+    bool ok = true;
+    for (int t = 0; t < threads; t++) {
+        parts[t] = (struct EmpPayrollPart *)calloc(1, sizeof(struct EmpPayrollPart));
+        if (parts[t] == NULL) {
+            ok = false;
+            continue;
+        }
+        parts[t]->first_slot = slots * t / threads;
+        parts[t]->end_slot = slots * (t + 1) / threads;
+    }
+    for (int t = 0; ok && t < threads; t++) {
+        workers[t] = std::thread(emp_payrollWorker, parts[t]);
+    }
+
+    struct EmpPayrollTotals *totals = (struct EmpPayrollTotals *)calloc(1, sizeof(struct EmpPayrollTotals));
+    ok = ok && totals != NULL;
+    for (int t = 0; t < threads; t++) {
+        if (workers[t].joinable()) workers[t].join();
+        if (parts[t] == NULL) continue;
+        ok = ok && parts[t]->ok && emp_mergePayroll(totals, &parts[t]->totals);
+        emp_freeDepartments(parts[t]->totals.departments);
+        free(parts[t]);
+    }
+    if (!ok) {
+        emp_freePayroll(totals);
+        return NULL;
+    }
+    return totals;
+}
+
+static float emp_median(float salaries[], long count) {
+    float *middle = salaries + count / 2;
+    std::nth_element(salaries, middle, salaries + count);
+    if (count % 2 == 1) return *middle;
+    return (*std::max_element(salaries, middle) + *middle) / 2; // Mean of the two middle salaries
+}
+
+static int emp_compareDepartmentNames(const void *a, const void *b) {
+    return strcmp(emp_departmentName(*(const int *)a), emp_departmentName(*(const int *)b));
+}
+
+// Prints headcount and salary figures per department and hires per year.
+int emp_runPayroll(int threads) {
+    struct timespec start, end;
+    timespec_get(&start, TIME_UTC);
+    struct EmpPayrollTotals *totals = emp_aggregatePayroll(threads);
+    timespec_get(&end, TIME_UTC);
+    if (totals == NULL) {
+        printf("Error: Could not read %s for the payroll report.\n", EMP_FILENAME);
+        return 1;
+    }
+
+    // Departments with anyone in them, by name
+    int codes[EMP_MAX_DEPARTMENTS], used = 0;
+    for (int code = 0; code < EMP_MAX_DEPARTMENTS; code++) {
+        if (totals->departments[code].headcount > 0) codes[used++] = code;
+    }
+    qsort(codes, used, sizeof(int), emp_compareDepartmentNames);
+
+    printf("--- Payroll Report ---\n");
+    printf("%-*s %9s %15s %12s %12s %12s %12s\n", EMP_MAX_DEPT_LENGTH - 20, "Department", "Headcount",
+           "Total Salary", "Average", "Median", "Min", "Max");
+    for (int i = 0; i < used; i++) {
+        struct EmpDeptStats *stats = &totals->departments[codes[i]];
+        const char *department = codes[i] == 0 ? "(none)" : emp_departmentName(codes[i]);
+        printf("%-*.*s %9ld %15.2f %12.2f %12.2f %12.2f %12.2f\n", EMP_MAX_DEPT_LENGTH - 20, EMP_MAX_DEPT_LENGTH - 20,
+               department, stats->headcount, stats->total_salary, stats->total_salary / stats->headcount,
+               emp_median(stats->salaries, stats->headcount), stats->min_salary, stats->max_salary);
+    }
+
+    printf("\n%-10s %9s %15s\n", "Hired", "Headcount", "Avg Salary");
+    for (int year = 1; year < EMP_COHORT_YEARS; year++) {
+        if (totals->cohort_count[year] == 0) continue;
+        printf("%-10d %9ld %15.2f\n", year, totals->cohort_count[year], totals->cohort_salary[year] / totals->cohort_count[year]);
+    }
+    if (totals->cohort_count[0] > 0) {
+        printf("%-10s %9ld %15.2f\n", "unknown", totals->cohort_count[0], totals->cohort_salary[0] / totals->cohort_count[0]);
+    }
+
+    double seconds = (double)(end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    printf("\nAggregated %ld employee(s) in %.3f s.\n", totals->employees, seconds);
+    emp_freePayroll(totals);
+    return 0;
+}
+
+// --- Salary Statistics Implementation ---
+// Restores the min-heap order of heap (lowest salary at heap[0]) after heap[pos] was replaced by emp.
+static void emp_siftDown(struct Employee heap[], int size, int pos, const struct Employee *emp) {
+    while (true) {
+        int child = pos * 2 + 1;
+        if (child >= size) break;
+        if (child + 1 < size && heap[child + 1].salary < heap[child].salary) child++;
+        if (heap[child].salary >= emp->salary) break;
+        heap[pos] = heap[child];
+        pos = child;
+    }
+    heap[pos] = *emp;
+}
+
+/*
+ * Fills top with the k best-paid employees (of department_code, or of everyone
+ * if it is negative), highest salary first, in one pass over the file that
+ * keeps only a k-entry min-heap. Returns how many were found.
+ */
+int emp_topSalaries(int k, int department_code, struct Employee top[]) {
+    int size = 0;
+    FILE *fp = fopen(EMP_FILENAME, "rb");
+    struct Employee *block = (struct Employee *)malloc(EMP_PAYROLL_BLOCK * sizeof(struct Employee));
+    if (k > 0 && fp != NULL && block != NULL && fseek(fp, emp_store.header_size, SEEK_SET) == 0) {
+        size_t n;
+        while ((n = fread(block, sizeof(struct Employee), EMP_PAYROLL_BLOCK, fp)) > 0) {
+            for (size_t i = 0; i < n; i++) {
+                const struct Employee *emp = &block[i];
+                if (emp->employee_id == RS_TOMBSTONE || (department_code >= 0 && emp->department_code != department_code)) continue;
+                if (size < k) {
+                    int pos = size++;
+                    while (pos > 0 && top[(pos - 1) / 2].salary > emp->salary) {
+                        top[pos] = top[(pos - 1) / 2];
+                        pos = (pos - 1) / 2;
+                    }
+                    top[pos] = *emp;
+                } else if (emp->salary > top[0].salary) {
+                    emp_siftDown(top, size, 0, emp);
+                }
+            }
+        }
+    }
+    free(block);
+    if (fp != NULL) fclose(fp);
+
+    // Popping the min-heap yields ascending salaries; fill from the back for a descending list.
+    for (int last = size - 1; last > 0; last--) {
+        struct Employee lowest = top[0];
+        emp_siftDown(top, last, 0, &top[last]);
+        top[last] = lowest;
+    }
+    return size;
+}
+
+/*
+ * Computes salary percentiles (nearest rank; percents ascending, 0 to 100) of
+ * department_code, or of everyone if it is negative. One pass over the file
+ * collects just the salary column, and std::nth_element then selects each
+ * percentile from what lies above the previous one, so nothing is sorted.
+ * Returns the number of salaries, or -1 if memory runs out.
+ */
+long emp_salaryPercentiles(int department_code, const double percents[], int count, float results[]) {
+    long size = 0, capacity = 0;
+    float *salaries = NULL;
+    bool ok = true;
+    FILE *fp = fopen(EMP_FILENAME, "rb");
+    struct Employee *block = (struct Employee *)malloc(EMP_PAYROLL_BLOCK * sizeof(struct Employee));
+    if (block == NULL) ok = false;
+    if (ok && fp != NULL && fseek(fp, emp_store.header_size, SEEK_SET) == 0) {
+        size_t n;
+        while (ok && (n = fread(block, sizeof(struct Employee), EMP_PAYROLL_BLOCK, fp)) > 0) {
+            if (size + (long)n > capacity) {
+                long grown = capacity > 0 ? capacity * 2 : EMP_PAYROLL_BLOCK;
+                float *more = (float *)realloc(salaries, grown * sizeof(float));
+                if (more == NULL) {
+                    ok = false;
+                    break;
+                }
+                salaries = more;
+                capacity = grown;
+            }
+            for (size_t i = 0; i < n; i++) {
+                if (block[i].employee_id == RS_TOMBSTONE || (department_code >= 0 && block[i].department_code != department_code)) continue;
+                salaries[size++] = block[i].salary;
+            }
+        }
+    }
+    free(block);
+    if (fp != NULL) fclose(fp);
+
+    long from = 0;
+    for (int p = 0; ok && size > 0 && p < count; p++) {
+        long rank = (long)ceil(percents[p] / 100.0 * size); // 1-based nearest rank
+        long index = rank > 0 ? rank - 1 : 0;
+        if (index >= size) index = size - 1;
+        if (index < from) index = from;
+        std::nth_element(salaries + from, salaries + index, salaries + size);
+        results[p] = salaries[index];
+        from = index; // Everything before index is no larger, so later percentiles look only from here
+    }
+    free(salaries);
+    return ok ? size : -1;
+}
+
+// Prints the k best-paid employees and the salary percentiles, for one
+// department or (department NULL) for everyone.
+int emp_runSalaryStats(int k, const char *department) {
+    int code = -1;
+    if (department != NULL) {
+        code = emp_findDepartment(department);
+        if (code < 0) {
+            printf("No employees in department '%s'.\n", department);
+            return 0;
+        }
+    }
+    if (k < 0) k = 0;
+    static const double percents[] = { 0, 10, 25, 50, 75, 90, 99, 100 };
+    const int percent_count = sizeof(percents) / sizeof(percents[0]);
+    float results[sizeof(percents) / sizeof(percents[0])];
+    long count = emp_salaryPercentiles(code, percents, percent_count, results);
+    struct Employee *top = (struct Employee *)malloc((k > 0 ? k : 1) * sizeof(struct Employee));
+    if (count < 0 || top == NULL) {
+        printf("Error: Not enough memory for salary statistics.\n");
+        free(top);
+        return 1;
+    }
+    if (count == 0) {
+        printf("No employees%s%s.\n", department != NULL ? " in department " : "", department != NULL ? department : "");
+        free(top);
+        return 0;
+    }
+
+    printf("Salary percentiles of %ld employee(s)%s%s:\n", count, department != NULL ? " in " : "", department != NULL ? department : "");
+    for (int p = 0; p < percent_count; p++) {
+        printf("  p%-4.0f %12.2f\n", percents[p], results[p]);
+    }
+
+    int found = emp_topSalaries(k, code, top);
+    if (found > 0) {
+        printf("\nTop %d salar%s:\n", found, found == 1 ? "y" : "ies");
+        printf("%-8s %-*s %-*s %-15s\n", "ID", EMP_MAX_NAME_LENGTH / 2, "Name", EMP_MAX_DEPT_LENGTH / 2, "Department", "Salary");
+        for (int i = 0; i < found; i++) {
+            printf("%-8d %-*.*s %-*.*s %-15.2f\n", top[i].employee_id,
+                   EMP_MAX_NAME_LENGTH / 2, EMP_MAX_NAME_LENGTH / 2, top[i].name,
+                   EMP_MAX_DEPT_LENGTH / 2, EMP_MAX_DEPT_LENGTH / 2, emp_departmentName(top[i].department_code),
+                   top[i].salary);
+        }
+    }
+    free(top);
+    return 0;
+}
+
+// --- CSV Import/Export Implementation ---
+// Copies the field at *cursor (quoted or not, ending at a comma or line_end)
+// into dest and advances past it. Returns 1 if a comma followed, 0 at the end
+// of the line, -1 if the field is too long or badly quoted.
+static int emp_csvNextField(const char **cursor, const char *line_end, char *dest, size_t dest_size) {
+    const char *p = *cursor;
+    size_t length = 0;
+    if (p < line_end && *p == '"') {
+        p++;
+        while (true) {
+            if (p >= line_end) return -1; // No closing quote
+            if (*p == '"') {
+                if (p + 1 < line_end && p[1] == '"') p++; // "" is a literal quote
+                else break;
+            }
+            if (length + 1 >= dest_size) return -1;
+            dest[length++] = *p++;
+        }
+        p++; // Closing quote
+        if (p < line_end && *p != ',') return -1;
+    } else {
+        while (p < line_end && *p != ',') {
+            if (length + 1 >= dest_size) return -1;
+            dest[length++] = *p++;
+        }
+    }
+    dest[length] = '\0';
+    *cursor = p + 1;
+    return p < line_end ? 1 : 0;
+}
+
+// Parses a positive employee_id: digits only, at most 9 of them.
+static bool emp_parseId(const char *text, int *id) {
+    return emp_parseDigits(&text, 9, id) && *text == '\0' && *id > 0;
+}
+
+// Parses a salary of the form 12345 or 12345.67, up to EMP_MAX_SALARY.
+static bool emp_parseSalary(const char *text, float *salary) {
+    int whole, cents = 0;
+    if (!emp_parseDigits(&text, 9, &whole)) return false;
+    if (*text == '.') {
+        text++;
+        const char *fraction = text;
+        if (!emp_parseDigits(&text, 2, &cents)) return false;
+        if (text - fraction == 1) cents *= 10;
+    }
+    if (*text != '\0') return false;
+    double value = whole + cents / 100.0;
+    *salary = (float)value;
+    return value <= EMP_MAX_SALARY;
+}
+
+// Parses one CSV line of chunk into emp; returns NULL or what was wrong with it.
+// Only reads the department dictionary, so chunks can be parsed in parallel.
+static const char *emp_parseCsvLine(struct EmpCsvChunk *chunk, const char *line, const char *line_end, struct Employee *emp) {
+    char field[EMP_MAX_NAME_LENGTH], department[EMP_MAX_DEPT_LENGTH];
+    memset(emp, 0, sizeof(struct Employee));
+    if (emp_csvNextField(&line, line_end, field, sizeof(field)) != 1 || !emp_parseId(field, &emp->employee_id)) {
+        return "employee_id must be a positive whole number";
+    }
+    if (emp_csvNextField(&line, line_end, emp->name, EMP_MAX_NAME_LENGTH) != 1) {
+        return "name is missing, badly quoted or longer than 99 characters";
+    }
+    if (emp_csvNextField(&line, line_end, department, EMP_MAX_DEPT_LENGTH) != 1) {
+        return "department is missing, badly quoted or longer than 49 characters";
+    }
+    int code = emp_findDepartment(department);
+    if (code < 0) {
+        for (code = 0; code < chunk->new_department_count; code++) {
+            if (strcmp(chunk->new_departments[code], department) == 0) break;
+        }
+        if (code == EMP_MAX_DEPARTMENTS) return "too many departments";
+        if (code == chunk->new_department_count) strcpy(chunk->new_departments[chunk->new_department_count++], department);
+        code += EMP_MAX_DEPARTMENTS;
+    }
+    emp->department_code = (unsigned char)code;
+    if (emp_csvNextField(&line, line_end, field, sizeof(field)) != 1 || !emp_parseSalary(field, &emp->salary)) {
+        return "salary must be a number from 0 to 100000000, such as 50000 or 50000.00";
+    }
+    if (emp_csvNextField(&line, line_end, field, sizeof(field)) != 0 ||
+        (field[0] != '\0' && !emp_parseDate(field, &emp->hire_date))) {
+        return "hire_date must be a YYYY-MM-DD date, left empty if unknown, and the last field";
+    }
+    return NULL;
+}
+
+// Parses every line of a chunk; stops at the first bad line.
+static void emp_parseCsvChunk(struct EmpCsvChunk *chunk) {
+    const char *line = chunk->begin;
+    while (line < chunk->end && chunk->error == NULL) {
+        const char *newline = (const char *)memchr(line, '\n', chunk->end - line);
+        const char *next = newline != NULL ? newline + 1 : chunk->end;
+        const char *line_end = newline != NULL ? newline : chunk->end;
+        if (line_end > line && line_end[-1] == '\r') line_end--;
+        if (line_end > line) { // Blank lines are skipped
+            if (chunk->count == chunk->capacity) {
+                long capacity = chunk->capacity > 0 ? chunk->capacity * 2 : 1024;
+                struct Employee *rows = (struct Employee *)realloc(chunk->rows, capacity * sizeof(struct Employee));
+                if (rows == NULL) {
+                    chunk->error_line = line;
+                    chunk->error = "out of memory";
+                    break;
+                }
+                chunk->rows = rows;
+                chunk->capacity = capacity;
+            }
+            chunk->error = emp_parseCsvLine(chunk, line, line_end, &chunk->rows[chunk->count]);
+            if (chunk->error != NULL) chunk->error_line = line;
+            else chunk->count++;
+        }
+        line = next;
+    }
+}
+
+// Reads a whole file into a malloc'd buffer; NULL if it cannot.
+static char *emp_readWholeFile(const char *filename, long *size) {
+    FILE *fp = fopen(filename, "rb");
+    if (fp == NULL) return NULL;
+    char *buffer = NULL;
+    if (fseek(fp, 0, SEEK_END) == 0 && (*size = ftell(fp)) >= 0 && fseek(fp, 0, SEEK_SET) == 0) {
+        buffer = (char *)malloc(*size > 0 ? *size : 1);
+        if (buffer != NULL && fread(buffer, 1, *size, fp) != (size_t)*size) {
+            free(buffer);
+            buffer = NULL;
+        }
+    }
+    fclose(fp);
+    return buffer;
+}
+
+// Adds id to an open-addressing set of employee ids (0 marks a free slot; ids
+// are positive). capacity is a power of two above the number of ids added.
+// Returns false if id was already there.
+static bool emp_idSetAdd(int set[], long capacity, int id) {
+    unsigned long pos = ((unsigned long)id * 2654435761u) & (capacity - 1);
+    while (set[pos] != 0) {
+        if (set[pos] == id) return false;
+        pos = (pos + 1) & (capacity - 1);
+    }
+    set[pos] = id;
+    return true;
+}
+
+/*
+ * Adds every employee in a CSV file (header line optional; columns as in
+ * EMP_CSV_HEADER) to employees.dat. The file is split at line boundaries into
+ * one chunk per thread (threads <= 0: one per core, fewer for small files)
+ * and the chunks are parsed in parallel. Nothing is written unless every line
+ * parses and no employee_id repeats or already exists; then the old and new
+ * employees are saved together in one sequential write and the indexes are
+ * rebuilt. Returns the number imported, or -1 after printing why not.
+ */
+long emp_importCsv(const char *filename, int threads) {
+    long size = 0;
+    char *text = emp_readWholeFile(filename, &size);
+    if (text == NULL) {
+        perror("Error reading CSV file");
+        return -1;
+    }
+    const char *begin = text, *end = text + size;
+    if ((size_t)size >= strlen(EMP_CSV_HEADER) && memcmp(text, EMP_CSV_HEADER, strlen(EMP_CSV_HEADER)) == 0) {
+        const char *newline = (const char *)memchr(text, '\n', size);
+        begin = newline != NULL ? newline + 1 : end;
+    }
+
+    if (threads <= 0) threads = (int)std::thread::hardware_concurrency();
+    long most = (end - begin) / EMP_CSV_MIN_CHUNK + 1;
+    if (threads > most) threads = (int)most;
+    if (threads <= 0) threads = 1;
+    if (threads > EMP_MAX_THREADS) threads = EMP_MAX_THREADS;
+
+    static struct EmpCsvChunk chunks[EMP_MAX_THREADS];
+    std::thread workers[EMP_MAX_THREADS];
+    memset(chunks, 0, sizeof(chunks));
+    const char *chunk_begin = begin;
+    for (int t = 0; t < threads; t++) {
+        const char *chunk_end = t == threads - 1 ? end : begin + (end - begin) * (t + 1) / threads;
+        if (chunk_end < chunk_begin) chunk_end = chunk_begin;
+        const char *newline = chunk_end < end ? (const char *)memchr(chunk_end, '\n', end - chunk_end) : NULL;
+        if (t < threads - 1) chunk_end = newline != NULL ? newline + 1 : end;
+        chunks[t].begin = chunk_begin;
+        chunks[t].end = chunk_end;
+        chunk_begin = chunk_end;
+    }
+    for (int t = 1; t < threads; t++) workers[t] = std::thread(emp_parseCsvChunk, &chunks[t]);
+    emp_parseCsvChunk(&chunks[0]);
+    for (int t = 1; t < threads; t++) workers[t].join();
+
+    long imported = 0;
+    const char *error = NULL;
+    for (int t = 0; t < threads && error == NULL; t++) {
+        imported += chunks[t].count;
+        if (chunks[t].error != NULL) {
+            long line = 1;
+            for (const char *p = text; p < chunks[t].error_line; p++) {
+                if (*p == '\n') line++;
+            }
+            printf("Error: %s line %ld: %s.\n", filename, line, chunks[t].error);
+            error = chunks[t].error;
+        }
+    }
+
+    // Existing employees first, then the new rows in file order
+    long slots = 0;
+    FILE *fp = fopen(EMP_FILENAME, "rb");
+    if (fp != NULL) {
+        slots = rs_countSlots(&emp_store, fp);
+        fclose(fp);
+    }
+    long capacity = 1024;
+    while (capacity < (slots + imported) * 2) capacity *= 2;
+    struct Employee *employees = NULL;
+    int *ids = NULL;
+    if (error == NULL && slots + imported > 0x7fffffffL) {
+        printf("Error: Too many employees for one file.\n");
+        error = "too many";
+    }
+    if (error == NULL) {
+        employees = (struct Employee *)malloc((slots + imported > 0 ? slots + imported : 1) * sizeof(struct Employee));
+        ids = (int *)calloc(capacity, sizeof(int));
+        if (employees == NULL || ids == NULL) {
+            printf("Error: Not enough memory to import %s.\n", filename);
+            error = "out of memory";
+        }
+    }
+    long total = 0;
+    if (error == NULL) {
+        total = rs_loadAll(&emp_store, employees, (int)slots);
+        for (long i = 0; i < total; i++) emp_idSetAdd(ids, capacity, employees[i].employee_id);
+        for (int t = 0; t < threads && error == NULL; t++) {
+            int codes[EMP_MAX_DEPARTMENTS]; // For the chunk's new departments
+            for (int d = 0; d < chunks[t].new_department_count && error == NULL; d++) {
+                codes[d] = emp_addDepartment(chunks[t].new_departments[d]);
+                if (codes[d] < 0) error = "too many departments";
+            }
+            for (long i = 0; i < chunks[t].count && error == NULL; i++) {
+                struct Employee *emp = &chunks[t].rows[i];
+                if (emp->department_code >= EMP_MAX_DEPARTMENTS) {
+                    emp->department_code = (unsigned char)codes[emp->department_code - EMP_MAX_DEPARTMENTS];
+                }
+                if (!emp_idSetAdd(ids, capacity, chunks[t].rows[i].employee_id)) {
+                    printf("Error: employee_id %d is already in %s or earlier in %s.\n",
+                           chunks[t].rows[i].employee_id, EMP_FILENAME, filename);
+                    error = "duplicate";
+                    break;
+                }
+                employees[total++] = chunks[t].rows[i];
+            }
+        }
+    }
+    if (error == NULL && !rs_saveAll(&emp_store, employees, (int)total)) {
+        perror("Error saving imported employees");
+        error = "save failed";
+    }
+    if (error == NULL) emp_rebuildIndexes();
+
+    for (int t = 0; t < threads; t++) free(chunks[t].rows);
+    free(employees);
+    free(ids);
+    free(text);
+    return error == NULL ? imported : -1;
+}
+
+// Writes field to out, quoted if it holds a comma, quote or line break.
+static void emp_writeCsvField(FILE *out, const char *field) {
+    if (strpbrk(field, ",\"\r\n") == NULL) {
+        fputs(field, out);
         return;
     }
+    fputc('"', out);
+    for (const char *c = field; *c != '\0'; c++) {
+        if (*c == '"') fputc('"', out);
+        fputc(*c, out);
+    }
+    fputc('"', out);
+}
 
-    for (int i = delete_index; i < count - 1; i++) {
-        employees[i] = employees[i+1];
+// Streams every employee to a CSV file ("-" for standard output) a block at a
+// time, in file order. Returns the number written, or -1 on error.
+long emp_exportCsv(const char *filename) {
+    bool to_stdout = strcmp(filename, "-") == 0;
+    FILE *out = to_stdout ? stdout : fopen(filename, "w");
+    if (out == NULL) {
+        perror("Error opening CSV file for writing");
+        return -1;
     }
-    count--;
+    static char out_buffer[1 << 16];
+    if (!to_stdout) setvbuf(out, out_buffer, _IOFBF, sizeof(out_buffer));
+    fprintf(out, "%s\n", EMP_CSV_HEADER);
 
-    emp_saveEmployees(employees, count);
-    printf("\nEmployee with ID %d deleted successfully!\n", delete_id);
-}
\ No newline at end of file
+    long count = 0;
+    FILE *fp = fopen(EMP_FILENAME, "rb");
+    struct Employee *block = (struct Employee *)malloc(EMP_PAYROLL_BLOCK * sizeof(struct Employee));
+    if (fp != NULL && block != NULL && fseek(fp, emp_store.header_size, SEEK_SET) == 0) {
+        size_t n;
+        char hire_date[EMP_MAX_DATE_LENGTH];
+        while ((n = fread(block, sizeof(struct Employee), EMP_PAYROLL_BLOCK, fp)) > 0) {
+            for (size_t i = 0; i < n; i++) {
+                struct Employee *emp = &block[i];
+                if (emp->employee_id == RS_TOMBSTONE) continue;
+                emp->name[EMP_MAX_NAME_LENGTH - 1] = '\0';
+                fprintf(out, "%d,", emp->employee_id);
+                emp_writeCsvField(out, emp->name);
+                fputc(',', out);
+                emp_writeCsvField(out, emp_departmentName(emp->department_code));
+                if (emp->hire_date != 0) emp_formatDate(emp->hire_date, hire_date);
+                else hire_date[0] = '\0';
+                fprintf(out, ",%.2f,%s\n", emp->salary, hire_date);
+                count++;
+            }
+        }
+    }
+    free(block);
+    if (fp != NULL) fclose(fp);
+    bool ok = !ferror(out) && fflush(out) == 0;
+    if (!to_stdout && fclose(out) != 0) ok = false;
+    if (!ok) {
+        perror("Error writing CSV file");
+        return -1;
+    }
+    return count;
+}
+
+// --- Benchmark Implementation ---
+// Times the scalar and vector name searches over EMP_BENCH_NAME_ROWS generated
+// names with the same needles; fails if they disagree or memory runs out. No
+// file is touched.
+int emp_runNameBench(int operations) {
+    if (operations <= 0) operations = EMP_BENCH_OPERATIONS;
+    static const char *first_names[] = { "Ada", "Grace", "Alan", "Edsger", "Barbara", "Donald", "Margaret", "Linus" };
+    static const char *last_names[] = { "Lovelace", "Hopper", "Turing", "Dijkstra", "Liskov", "Knuth", "Hamilton",
+                                        "Torvalds", "McCarthy", "Ritchie", "Thompson", "Kernighan", "Stroustrup",
+                                        "Wirth", "Backus", "Hoare" };
+    const int first_count = sizeof(first_names) / sizeof(first_names[0]);
+    const int last_count = sizeof(last_names) / sizeof(last_names[0]);
+
+    struct EmpNameColumn names;
+    memset(&names, 0, sizeof(names));
+    int *matches = (int *)malloc(EMP_BENCH_NAME_ROWS * sizeof(int));
+    double *samples = (double *)malloc(operations * sizeof(double));
+    bool ok = matches != NULL && samples != NULL;
+    char name[EMP_MAX_NAME_LENGTH];
+    for (int i = 0; ok && i < EMP_BENCH_NAME_ROWS; i++) {
+        snprintf(name, EMP_MAX_NAME_LENGTH, "%s %s %d", first_names[i % first_count],
+                 last_names[i / first_count % last_count], i);
+        ok = emp_nameColumnAdd(&names, name);
+    }
+    if (!ok) {
+        printf("Error: Not enough memory for the name search benchmark.\n");
+        free(matches);
+        free(samples);
+        emp_nameColumnFree(&names);
+        return 1;
+    }
+
+    // Mixed-case needles, so matching has to ignore case; the same sequence for both searches
+    int *expected = (int *)malloc(operations * sizeof(int));
+    for (int pass = 0; ok && pass < 2 && expected != NULL; pass++) {
+        srand(54321);
+        for (int op = 0; op < operations; op++) {
+            snprintf(name, EMP_MAX_NAME_LENGTH, "%s", last_names[rand() % last_count]);
+            for (char *c = name; *c != '\0'; c++) {
+                if (rand() % 2) *c = (char)toupper((unsigned char)*c);
+            }
+            double start = bench_nowMicros();
+            int count = pass == 0 ? emp_nameColumnSearchScalar(&names, name, matches, EMP_BENCH_NAME_ROWS)
+                                  : emp_nameColumnSearch(&names, name, matches, EMP_BENCH_NAME_ROWS);
+            samples[op] = bench_nowMicros() - start;
+            if (pass == 0) expected[op] = count;
+            else if (count != expected[op]) ok = false;
+        }
+        bench_printResult("employee", pass == 0 ? "name_search_scalar" : "name_search", EMP_BENCH_NAME_ROWS, samples, operations);
+    }
+    if (expected == NULL) ok = false;
+    if (!ok) printf("Error: Name searches disagree or ran out of memory.\n");
+    free(expected);
+    free(matches);
+    free(samples);
+    emp_nameColumnFree(&names);
+    return ok ? 0 : 1;
+}
+
+// Writes a synthetic employee file of the given size a block at a time: it can
+// be far larger than any array the menu loads.
+static bool emp_writeBenchFile(long records) {
+    char department[EMP_MAX_DEPT_LENGTH];
+    emp_resetDepartments();
+    for (int d = 0; d < 40; d++) {
+        snprintf(department, EMP_MAX_DEPT_LENGTH, "Department %d", d);
+        emp_addDepartment(department);
+    }
+    rs_dropIndex(&emp_store); // Written behind the store's back, so lookups scan
+    FILE *fp = fopen(EMP_FILENAME, "wb");
+    struct Employee *block = (struct Employee *)calloc(EMP_PAYROLL_BLOCK, sizeof(struct Employee));
+    bool ok = fp != NULL && block != NULL && fwrite(&emp_header, sizeof(emp_header), 1, fp) == 1;
+    for (long written = 0; ok && written < records; ) {
+        int n = records - written < EMP_PAYROLL_BLOCK ? (int)(records - written) : EMP_PAYROLL_BLOCK;
+        for (int i = 0; i < n; i++) {
+            long id = written + i;
+            block[i].employee_id = (int)(id + 1);
+            snprintf(block[i].name, EMP_MAX_NAME_LENGTH, "Employee %ld", id + 1);
+            block[i].department_code = (unsigned char)(1 + id % 40); // "Department <id % 40>"
+            block[i].salary = 30000.0f + (id * 37) % 90000;
+            block[i].hire_date = (int)((1990 + id % 35) * 10000 + (1 + id % 12) * 100 + 1 + id % 28);
+        }
+        ok = fwrite(block, sizeof(struct Employee), n, fp) == (size_t)n;
+        written += n;
+    }
+    free(block);
+    if (fp != NULL && fclose(fp) != 0) ok = false;
+    if (!ok) {
+        perror("Error writing the benchmark file");
+        remove(EMP_FILENAME);
+    }
+    return ok;
+}
+
+// Times EMP_BENCH_CSV_RUNS exports and imports of EMP_BENCH_CSV_ROWS employees
+// in EMP_BENCH_DIR; fails if an import does not bring back every row.
+int emp_runCsvBench() {
+    if (!bench_enterDir(EMP_BENCH_DIR)) return 1;
+    double samples[EMP_BENCH_CSV_RUNS];
+    bool ok = emp_writeBenchFile(EMP_BENCH_CSV_ROWS);
+    for (int run = 0; ok && run < EMP_BENCH_CSV_RUNS; run++) {
+        double start = bench_nowMicros();
+        ok = emp_exportCsv(EMP_BENCH_CSV_FILENAME) == EMP_BENCH_CSV_ROWS;
+        samples[run] = bench_nowMicros() - start;
+    }
+    if (ok) bench_printResult("employee", "csv_export", EMP_BENCH_CSV_ROWS, samples, EMP_BENCH_CSV_RUNS);
+    for (int run = 0; ok && run < EMP_BENCH_CSV_RUNS; run++) {
+        remove(EMP_FILENAME); // Every import starts from an empty store
+        double start = bench_nowMicros();
+        ok = emp_importCsv(EMP_BENCH_CSV_FILENAME, 0) == EMP_BENCH_CSV_ROWS;
+        samples[run] = bench_nowMicros() - start;
+    }
+    if (ok) bench_printResult("employee", "csv_import", EMP_BENCH_CSV_ROWS, samples, EMP_BENCH_CSV_RUNS);
+    else printf("Error: The CSV round trip lost employees.\n");
+    remove(EMP_BENCH_CSV_FILENAME);
+    remove(EMP_FILENAME);
+    remove(EMP_SALARY_INDEX_FILENAME);
+    remove(EMP_HIRED_INDEX_FILENAME);
+    rs_dropIndex(&emp_store);
+    return ok ? 0 : 1;
+}
+
+// Fills in employee number index of the benchmark file; its employee_id is index + 1.
+static void emp_benchGenerate(void *record, int index) {
+    struct Employee *employee = (struct Employee *)record;
+    employee->employee_id = index + 1;
+    snprintf(employee->name, EMP_MAX_NAME_LENGTH, "Employee %d", index + 1);
+    char department[EMP_MAX_DEPT_LENGTH];
+    snprintf(department, EMP_MAX_DEPT_LENGTH, "Department %d", index % 12);
+    employee->department_code = (unsigned char)emp_addDepartment(department);
+    employee->salary = 30000.0f + (index * 37) % 90000;
+    employee->hire_date = (2000 + index % 25) * 10000 + (1 + index % 12) * 100 + 1 + index % 28;
+}
+
+// The benchmark's whole-record update is a raise.
+static void emp_benchEdit(void *record) {
+    ((struct Employee *)record)->salary += 100.0f;
+}
+
+/*
+ * Times load, save, lookup, update and delete (bench_runStore), then updates of
+ * the salary field alone, department raises, top-K and percentile queries and
+ * indexed salary range queries against a synthetic employee file of the given
+ * size, the same way the menu operations do them, and prints the results as
+ * JSON lines. Runs in EMP_BENCH_DIR so real data is left alone.
+ *
+ * Name search and CSV export and import have their own benchmarks
+ * (--bench-names and --bench-csv), whose sizes do not depend on records.
+ */
+int emp_runBench(int records, int operations) {
+    if (records <= 0 || records > EMP_MAX_EMPLOYEES) records = EMP_MAX_EMPLOYEES;
+    if (operations <= 0) operations = EMP_BENCH_OPERATIONS;
+    if (!bench_enterDir(EMP_BENCH_DIR)) return 1;
+
+    static struct Employee employees[EMP_MAX_EMPLOYEES];
+    double *samples = (double *)malloc(operations * sizeof(double));
+    if (samples == NULL) {
+        printf("Error: Not enough memory for the benchmark.\n");
+        return 1;
+    }
+    bool ok = bench_runStore("employee", &emp_store, records, operations, emp_benchGenerate, emp_benchEdit);
+
+    for (int op = 0; op < operations; op++) {
+        int employee_id = rand() % records + 1;
+        float salary = 30000.0f + rand() % 90000;
+        double start = bench_nowMicros();
+        rs_updateField(&emp_store, employee_id, offsetof(struct Employee, salary), sizeof(float), &salary);
+        samples[op] = bench_nowMicros() - start;
+    }
+    bench_printResult("employee", "update_field", records, samples, operations);
+
+    char department[EMP_MAX_DEPT_LENGTH];
+    for (int op = 0; op < operations; op++) {
+        snprintf(department, EMP_MAX_DEPT_LENGTH, "Department %d", rand() % 12);
+        double start = bench_nowMicros();
+        emp_departmentRaise(department, 1.0f);
+        samples[op] = bench_nowMicros() - start;
+    }
+    bench_printResult("employee", "dept_raise", records, samples, operations);
+
+    struct Employee top[EMP_TOP_DEFAULT];
+    for (int op = 0; op < operations; op++) {
+        double start = bench_nowMicros();
+        emp_topSalaries(EMP_TOP_DEFAULT, -1, top);
+        samples[op] = bench_nowMicros() - start;
+    }
+    bench_printResult("employee", "top_k", records, samples, operations);
+
+    static const double percents[] = { 10, 25, 50, 75, 90, 99 };
+    float percentiles[sizeof(percents) / sizeof(percents[0])];
+    for (int op = 0; op < operations; op++) {
+        double start = bench_nowMicros();
+        emp_salaryPercentiles(-1, percents, sizeof(percents) / sizeof(percents[0]), percentiles);
+        samples[op] = bench_nowMicros() - start;
+    }
+    bench_printResult("employee", "percentiles", records, samples, operations);
+
+    emp_rebuildIndexes(); // The salary index has not followed the saves, updates and raises above
+    for (int op = 0; op < operations; op++) {
+        long long low = emp_salaryKey(30000.0f + rand() % 89000);
+        double start = bench_nowMicros();
+        emp_rangeQuery(EMP_SALARY_INDEX_FILENAME, low, low + 100000, employees, EMP_MAX_EMPLOYEES); // 1000.00 wide
+        samples[op] = bench_nowMicros() - start;
+    }
+    bench_printResult("employee", "range", records, samples, operations);
+
+    free(samples);
+    remove(EMP_FILENAME);
+    remove(EMP_SALARY_INDEX_FILENAME);
+    remove(EMP_HIRED_INDEX_FILENAME);
+    rs_dropIndex(&emp_store);
+    return ok ? 0 : 1;
+}
+
+/*
+ * Writes a synthetic employee file of the given size (default 10M records) and
+ * times the payroll aggregation with 1, 2, 4, ... threads up to the core count,
+ * printing one JSON line per thread count. Runs in EMP_BENCH_DIR.
+ */
+int emp_runPayrollBench(long records) {
+    if (records <= 0) records = EMP_BENCH_PAYROLL_RECORDS;
+    if (!bench_enterDir(EMP_BENCH_DIR)) return 1;
+
+    if (!emp_writeBenchFile(records)) return 1;
+
+    bool ok = true;
+    int cores = (int)std::thread::hardware_concurrency();
+    if (cores <= 0) cores = 1;
+    if (cores > EMP_MAX_THREADS) cores = EMP_MAX_THREADS;
+    double samples[EMP_BENCH_PAYROLL_RUNS];
+    char op[32];
+    for (int threads = 1; ok; threads *= 2) {
+        if (threads > cores) threads = cores; // Always finish with every core busy
+        for (int run = 0; ok && run < EMP_BENCH_PAYROLL_RUNS; run++) {
+            double start = bench_nowMicros();
+            struct EmpPayrollTotals *totals = emp_aggregatePayroll(threads);
+            samples[run] = bench_nowMicros() - start;
+            ok = totals != NULL && totals->employees == records;
+            emp_freePayroll(totals);
+        }
+        if (!ok) break;
+        snprintf(op, sizeof(op), "payroll_%dt", threads);
+        bench_printResult("employee", op, records, samples, EMP_BENCH_PAYROLL_RUNS);
+        if (threads == cores) break;
+    }
+    if (!ok) printf("Error: The payroll report did not count every employee.\n");
+    remove(EMP_FILENAME);
+    return ok ? 0 : 1;
+}
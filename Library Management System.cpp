@@ -9,11 +9,18 @@
     #include <unistd.h>
 #endif
 
+#include "record_store.h"
+#include "bench.h"
+
 // --- Constants ---
 #define LIB_FILENAME "library.dat"
+#define LIB_INDEX_FILENAME "library.idx" // Sorted book_id -> slot, kept by the record store
+#define LIB_FREE_FILENAME "library_free.lst" // Slots of deleted books, reused by the next add
 #define LIB_MAX_TITLE_LENGTH 100
 #define LIB_MAX_AUTHOR_LENGTH 50
 #define LIB_MAX_BOOKS 1000
+#define LIB_BENCH_DIR "library_bench" // Scratch directory for --bench; the real library.dat is never touched
+#define LIB_BENCH_OPERATIONS 200 // Timed repetitions of each benchmark operation unless another count is given
 
 // --- Structure Definition ---
 struct Book {
@@ -23,6 +30,10 @@ struct Book {
     bool is_issued; // true if issued, false if available
 };
 
+// library.dat as a record store keyed by book_id; deleted books leave a tombstone for the next add
+static const struct RecordStore lib_store = { LIB_FILENAME, sizeof(struct Book), offsetof(struct Book, book_id), sizeof(int), 0, NULL,
+                                              LIB_INDEX_FILENAME, LIB_FREE_FILENAME };
+
 // --- Function Prototypes ---
 // Utility
 void lib_clearScreen();
@@ -41,9 +52,22 @@ void lib_deleteBook();
 int lib_loadBooks(struct Book book_array[]);
 void lib_saveBooks(struct Book book_array[], int count);
 
+// Benchmark
+int lib_runBench(int records, int operations);
+
 // --- Main Function for Library System ---
-int main() {
+int main(int argc, char *argv[]) {
     int choice;
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0) {
+        return lib_runBench(argc > 2 ? atoi(argv[2]) : LIB_MAX_BOOKS, argc > 3 ? atoi(argv[3]) : LIB_BENCH_OPERATIONS);
+    }
+    if (argc > 1 && strcmp(argv[1], "--defer-sync") == 0) {
+        rs_deferSync(true); // Edits are synced once, on exit
+    } else if (argc > 1) {
+        printf("Usage: %s [--defer-sync] [--bench [records] [operations]]\n", argv[0]);
+        return 1;
+    }
+    rs_openIndex(&lib_store);
     do {
         lib_clearScreen();
         lib_displayMenu();
@@ -69,6 +93,7 @@ int main() {
         }
     } while (choice != 0);
 
+    rs_flush(&lib_store);
     return 0;
 }
 
@@ -108,25 +133,11 @@ void lib_displayMenu() {
 
 // --- File I/O Helper Functions Implementation ---
 int lib_loadBooks(struct Book book_array[]) {
-    FILE *fp = fopen(LIB_FILENAME, "rb");
-    if (fp == NULL) return 0; // File doesn't exist or empty
-
-    int count = 0;
-    while (count < LIB_MAX_BOOKS && fread(&book_array[count], sizeof(struct Book), 1, fp) == 1) {
-        count++;
-    }
-    fclose(fp);
-    return count;
+    return rs_loadAll(&lib_store, book_array, LIB_MAX_BOOKS);
 }
 
 void lib_saveBooks(struct Book book_array[], int count) {
-    FILE *fp = fopen(LIB_FILENAME, "wb"); // Overwrites existing file
-    if (fp == NULL) {
-        perror("Error opening file for saving books");
-        return;
-    }
-    fwrite(book_array, sizeof(struct Book), count, fp);
-    fclose(fp);
+    rs_saveAll(&lib_store, book_array, count);
 }
 
 // --- CRUD Operations Implementation ---
@@ -162,10 +173,9 @@ void lib_addBook() {
     new_book.is_issued = false; // New books are initially not issued
 
     if (current_count < LIB_MAX_BOOKS) {
-        existing_books[current_count] = new_book;
-        current_count++;
-        lib_saveBooks(existing_books, current_count);
-        printf("\nBook added successfully!\n");
+        if (rs_append(&lib_store, &new_book) >= 0) {
+            printf("\nBook added successfully!\n");
+        }
     } else {
         printf("\nSystem capacity reached. Cannot add more books.\n");
     }
@@ -256,7 +266,6 @@ void lib_issueReturnBook(bool issue_operation) {
     lib_clearScreen();
     printf("--- %s Book ---\n", issue_operation ? "Issue" : "Return");
     int book_id;
-    bool found = false;
 
     printf("Enter Book ID: ");
     while (scanf("%d", &book_id) != 1 || book_id <= 0) {
@@ -265,43 +274,27 @@ void lib_issueReturnBook(bool issue_operation) {
     }
     lib_clearInputBuffer();
 
-    struct Book books[LIB_MAX_BOOKS];
-    int count = lib_loadBooks(books);
-
-    for (int i = 0; i < count; i++) {
-        if (books[i].book_id == book_id) {
-            found = true;
-            if (issue_operation) { // Issue operation
-                if (!books[i].is_issued) {
-                    books[i].is_issued = true;
-                    printf("Book '%s' (ID: %d) successfully issued.\n", books[i].title, books[i].book_id);
-                } else {
-                    printf("Book '%s' (ID: %d) is already issued.\n", books[i].title, books[i].book_id);
-                }
-            } else { // Return operation
-                if (books[i].is_issued) {
-                    books[i].is_issued = false;
-                    printf("Book '%s' (ID: %d) successfully returned.\n", books[i].title, books[i].book_id);
-                } else {
-                    printf("Book '%s' (ID: %d) is already available.\n", books[i].title, books[i].book_id);
-                }
-            }
-            lib_saveBooks(books, count); // Save changes
-            break;
-        }
-    }
-
-    if (!found) {
+    struct Book book;
+    if (!rs_find(&lib_store, book_id, &book)) {
         printf("\nBook with ID %d not found.\n", book_id);
+        return;
     }
+    if (book.is_issued == issue_operation) {
+        printf("Book '%s' (ID: %d) is already %s.\n", book.title, book.book_id, issue_operation ? "issued" : "available");
+        return;
+    }
+    book.is_issued = issue_operation;
+    if (rs_update(&lib_store, &book) < 0) { // Save changes to this book only
+        printf("Error: Could not save the change to book ID %d.\n", book.book_id);
+        return;
+    }
+    printf("Book '%s' (ID: %d) successfully %s.\n", book.title, book.book_id, issue_operation ? "issued" : "returned");
 }
 
 void lib_deleteBook() {
     lib_clearScreen();
     printf("--- Delete Book ---\n");
     int delete_id;
-    bool found = false;
-    int delete_index = -1;
 
     printf("Enter Book ID to delete: ");
     while (scanf("%d", &delete_id) != 1 || delete_id <= 0) {
@@ -310,28 +303,40 @@ void lib_deleteBook() {
     }
     lib_clearInputBuffer();
 
-    struct Book books[LIB_MAX_BOOKS];
-    int count = lib_loadBooks(books);
-
-    for (int i = 0; i < count; i++) {
-        if (books[i].book_id == delete_id) {
-            found = true;
-            delete_index = i;
-            break;
-        }
-    }
-
-    if (!found) {
+    if (!rs_delete(&lib_store, delete_id)) {
         printf("\nBook with ID %d not found.\n", delete_id);
         return;
     }
+    printf("\nBook with ID %d deleted successfully!\n", delete_id);
+}
 
-    // Shift elements to overwrite the deleted book
-    for (int i = delete_index; i < count - 1; i++) {
-        books[i] = books[i+1];
-    }
-    count--; // Decrement the total count
+// --- Benchmark Implementation ---
+// Fills in book number index of the benchmark library; its book_id is index + 1.
+static void lib_benchGenerate(void *record, int index) {
+    struct Book *book = (struct Book *)record;
+    book->book_id = index + 1;
+    snprintf(book->title, LIB_MAX_TITLE_LENGTH, "Synthetic Title %d", index + 1);
+    snprintf(book->author, LIB_MAX_AUTHOR_LENGTH, "Author %d", index % 97);
+}
 
-    lib_saveBooks(books, count); // Save the modified list
-    printf("\nBook with ID %d deleted successfully!\n", delete_id);
-}
\ No newline at end of file
+// The benchmark's update is an issue or a return.
+static void lib_benchEdit(void *record) {
+    struct Book *book = (struct Book *)record;
+    book->is_issued = !book->is_issued;
+}
+
+/*
+ * Times load, save, lookup, update (issue/return) and delete against a synthetic
+ * library of the given size, the same way the menu operations do them, and prints
+ * the results as JSON lines. Runs in LIB_BENCH_DIR so real data is left alone.
+ */
+int lib_runBench(int records, int operations) {
+    if (records <= 0 || records > LIB_MAX_BOOKS) records = LIB_MAX_BOOKS;
+    if (operations <= 0) operations = LIB_BENCH_OPERATIONS;
+    if (!bench_enterDir(LIB_BENCH_DIR)) return 1;
+
+    bool ok = bench_runStore("library", &lib_store, records, operations, lib_benchGenerate, lib_benchEdit);
+    remove(LIB_FILENAME);
+    rs_dropIndex(&lib_store);
+    return ok ? 0 : 1;
+}
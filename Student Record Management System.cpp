@@ -10,10 +10,17 @@
     #include <unistd.h> // For usleep() on Unix/Linux systems if specific delays are needed
 #endif
 
+#include "record_store.h" // Shared fixed-size record file routines (rs_ functions)
+#include "bench.h"        // Shared --bench timing and JSON result lines (bench_ functions)
+
 // --- Constants ---
 #define FILENAME "students.dat"      // The name of the binary file to store student data
+#define INDEX_FILENAME "students.idx" // Sorted roll_no -> slot index, kept up to date by the record store
+#define FREE_FILENAME "students_free.lst" // Slots of deleted students, reused by the next new student
 #define MAX_NAME_LENGTH 50           // Maximum length for a student's name
 #define MAX_STUDENTS 1000            // Maximum number of students the system can handle in memory
+#define BENCH_DIR "student_bench"    // Scratch directory used by --bench, so real data is never touched
+#define BENCH_OPERATIONS 200         // Default number of timed repetitions of each benchmark operation
 
 // --- Structure Definition ---
 // Defines the blueprint for a single student record
@@ -23,6 +30,20 @@ struct Student {
     float marks;                // Student's marks (e.g., out of 100)
 };
 
+// Describes students.dat to the shared record store: fixed-size Student records,
+// no file header, looked up by roll_no. A deleted student is overwritten with an
+// all-zero "tombstone" record (roll_no 0), and the next new student reuses its slot.
+static const struct RecordStore student_store = {
+    FILENAME,                          // File holding the records
+    sizeof(struct Student),            // Size of one record
+    offsetof(struct Student, roll_no), // Where the key sits inside a record
+    sizeof(int),                       // Size of the key
+    0,                                 // No header before the first record
+    NULL,
+    INDEX_FILENAME,                    // Finds a roll number without reading the whole file
+    FREE_FILENAME                      // Lets a new student take a deleted student's slot without a scan
+};
+
 // --- Function Prototypes ---
 // Utility functions for UI and input handling
 void clearScreen();
@@ -42,10 +63,26 @@ void deleteStudent();
 int loadStudentsFromFile(struct Student student_array[]);
 void saveStudentsToFile(struct Student student_array[], int count);
 
+// Benchmark (run with: --bench [records] [operations])
+int runBench(int records, int operations);
+
 // --- Main Function ---
-int main() {
+int main(int argc, char *argv[]) {
     int choice; // To store user's menu choice
 
+    // Non-interactive benchmark mode; prints JSON lines and exits
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0) {
+        return runBench(argc > 2 ? atoi(argv[2]) : MAX_STUDENTS, argc > 3 ? atoi(argv[3]) : BENCH_OPERATIONS);
+    }
+    // --defer-sync: make edits durable once, on exit, instead of after every change
+    if (argc > 1 && strcmp(argv[1], "--defer-sync") == 0) {
+        rs_deferSync(true);
+    } else if (argc > 1) {
+        printf("Usage: %s [--defer-sync] [--bench [records] [operations]]\n", argv[0]);
+        return 1;
+    }
+    rs_openIndex(&student_store); // Rebuild the roll number index if the last run did not close it cleanly
+
     do {
         clearScreen();   // Clear the console for a clean menu display
         displayMenu();   // Show the main menu options
@@ -91,6 +128,7 @@ int main() {
 
     } while (choice != 0); // Continue loop until user chooses to exit
 
+    rs_flush(&student_store); // Sync any edits held back by --defer-sync
     return 0; // Indicate successful program execution
 }
 
@@ -137,46 +175,20 @@ void displayMenu() {
 
 /*
  * Loads all student records from the binary file into a Student array in memory.
+ * Deleted (tombstoned) records are skipped.
  * Returns the number of students loaded.
  */
 int loadStudentsFromFile(struct Student student_array[]) {
-    FILE *fp;
-    int count = 0;
-
-    fp = fopen(FILENAME, "rb"); // Open file in read binary mode
-    if (fp == NULL) {
-        // If file doesn't exist yet (first run) or cannot be opened, return 0 students.
-        // perror("Error opening file for reading"); // Uncomment for debugging file issues
-        return 0;
-    }
-
-    // Read student records one by one until EOF or MAX_STUDENTS is reached
-    while (count < MAX_STUDENTS && fread(&student_array[count], sizeof(struct Student), 1, fp) == 1) {
-        count++;
-    }
-
-    fclose(fp); // Close the file
-    return count; // Return the total number of students loaded
+    return rs_loadAll(&student_store, student_array, MAX_STUDENTS);
 }
 
 /*
  * Saves all student records from a Student array in memory to the binary file.
- * This overwrites the existing file content.
+ * This overwrites the existing file content. The menu operations change single
+ * records in place instead; this is used to write a whole data set at once.
  */
 void saveStudentsToFile(struct Student student_array[], int count) {
-    FILE *fp;
-
-    // Open file in write binary mode. "wb" truncates the file if it exists.
-    fp = fopen(FILENAME, "wb");
-    if (fp == NULL) {
-        perror("Error opening file for writing (saving all students)");
-        return;
-    }
-
-    // Write all student records from the array to the file
-    fwrite(student_array, sizeof(struct Student), count, fp);
-
-    fclose(fp); // Close the file
+    rs_saveAll(&student_store, student_array, count);
 }
 
 // --- CRUD Operations Implementation ---
@@ -232,12 +244,11 @@ void addStudent() {
     }
     clearInputBuffer(); // Clear newline after scanf
 
-    // Add the new student to the array in memory
+    // Write the new student into a free slot (or at the end of the file)
     if (current_count < MAX_STUDENTS) {
-        current_students[current_count] = new_student;
-        current_count++;
-        saveStudentsToFile(current_students, current_count); // Save the updated list back to file
-        printf("\nStudent added successfully!\n");
+        if (rs_append(&student_store, &new_student) >= 0) {
+            printf("\nStudent added successfully!\n");
+        }
     } else {
         printf("\nSystem capacity reached. Cannot add more students.\n");
     }
@@ -354,9 +365,10 @@ void updateStudent() {
             }
             clearInputBuffer();
 
-            // Save the entire updated array back to the file
-            saveStudentsToFile(students, count);
-            printf("\nStudent record updated successfully!\n");
+            // Overwrite just this student's record in the file
+            if (rs_update(&student_store, &students[i]) >= 0) {
+                printf("\nStudent record updated successfully!\n");
+            }
             break; // Exit loop after updating
         }
     }
@@ -371,8 +383,6 @@ void deleteStudent() {
     clearScreen();
     printf("--- Delete Student Record ---\n");
     int delete_roll;
-    bool found = false;
-    int delete_index = -1; // To store the index of the student to be deleted
 
     // Get the roll number of the student to delete
     printf("Enter Roll Number of student to delete: ");
@@ -382,31 +392,45 @@ void deleteStudent() {
     }
     clearInputBuffer();
 
-    struct Student students[MAX_STUDENTS];
-    int count = loadStudentsFromFile(students); // Load all students into memory
-
-    // Find the student to delete and store their index
-    for (int i = 0; i < count; i++) {
-        if (students[i].roll_no == delete_roll) {
-            found = true;
-            delete_index = i;
-            break;
-        }
-    }
-
-    if (!found) {
+    // Mark the student's record as deleted (a tombstone) in place; the rest of the file is untouched
+    if (!rs_delete(&student_store, delete_roll)) {
         printf("\nStudent with Roll Number %d not found for deletion.\n", delete_roll);
         return;
     }
 
-    // Shift elements in the array to "overwrite" the deleted student's data
-    // This effectively removes the student from the in-memory array
-    for (int i = delete_index; i < count - 1; i++) {
-        students[i] = students[i+1];
-    }
-    count--; // Decrement the total count of students
-
-    // Save the modified (smaller) array back to the file, overwriting the old content
-    saveStudentsToFile(students, count);
     printf("\nStudent with Roll Number %d deleted successfully!\n", delete_roll);
-}
\ No newline at end of file
+}
+
+// --- Benchmark Implementation ---
+
+// Fills in synthetic student number `index` for the benchmark (roll number index + 1)
+static void benchGenerate(void *record, int index) {
+    struct Student *student = (struct Student *)record;
+    student->roll_no = index + 1;
+    snprintf(student->name, MAX_NAME_LENGTH, "Student %d", index + 1);
+    student->marks = (float)(index % 101);
+}
+
+// The benchmark's update: change the marks, as updateStudent would
+static void benchEdit(void *record) {
+    struct Student *student = (struct Student *)record;
+    student->marks = (float)((int)student->marks % 100 + 1);
+}
+
+// Benchmarks the record store: generates `records` synthetic students, then times
+// load, save, lookup, update (marks change) and delete `operations` times each,
+// doing exactly what the menu operations do (see bench_runStore). Everything happens
+// inside BENCH_DIR, so the real students.dat is never touched.
+// Returns 0 on success, 1 if the benchmark could not run or a lookup missed.
+int runBench(int records, int operations) {
+    if (records <= 0 || records > MAX_STUDENTS) records = MAX_STUDENTS;
+    if (operations <= 0) operations = BENCH_OPERATIONS;
+
+    // Move into the scratch directory (created if missing)
+    if (!bench_enterDir(BENCH_DIR)) return 1;
+
+    bool ok = bench_runStore("student", &student_store, records, operations, benchGenerate, benchEdit);
+    remove(FILENAME); // Leave only the (empty) scratch directory behind
+    rs_dropIndex(&student_store);
+    return ok ? 0 : 1;
+}
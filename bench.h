@@ -0,0 +1,153 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+/*
+ * Timing and reporting for the --bench modes of the Bank, Library, Employee
+ * and Student systems. Every program reports through bench_printResult, so
+ * they all compute p50/p99 the same way and print the same JSON line:
+ *
+ *   {"system":"bank","op":"lookup","records":10000,"ops":200,
+ *    "p50_us":1.2,"p99_us":3.4,"ops_per_sec":812345}
+ *
+ * bench_runStore times the operations every record store program shares
+ * (load, save, lookup, update, delete); a program adds its own after it.
+ *
+ * Header-only so each program still builds from its single .cpp file.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <time.h>
+#include "record_store.h"
+
+#ifdef _WIN32
+    #include <direct.h>
+#else
+    #include <unistd.h>
+    #include <sys/stat.h>
+#endif
+
+// Returns the current wall-clock time in microseconds
+static inline double bench_nowMicros() {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static inline int bench_compareDoubles(const void *a, const void *b) {
+    double lhs = *(const double *)a, rhs = *(const double *)b;
+    return (lhs > rhs) - (lhs < rhs);
+}
+
+// Prints one JSON line for an operation: latency percentiles (microseconds) and
+// throughput. samples[] holds count latencies and is sorted in place.
+static inline void bench_printResult(const char *system, const char *op, long records, double samples[], int count) {
+    double total = 0;
+    for (int i = 0; i < count; i++) total += samples[i];
+    qsort(samples, count, sizeof(double), bench_compareDoubles);
+    printf("{\"system\":\"%s\",\"op\":\"%s\",\"records\":%ld,\"ops\":%d,"
+           "\"p50_us\":%.1f,\"p99_us\":%.1f,\"ops_per_sec\":%.0f}\n",
+           system, op, records, count, samples[count / 2], samples[(count - 1) * 99 / 100],
+           total > 0 ? count / (total / 1e6) : 0.0);
+}
+
+// Creates the scratch directory if missing and makes it the working directory,
+// so a benchmark never touches the real data files.
+static inline bool bench_enterDir(const char *dir) {
+    #ifdef _WIN32
+        _mkdir(dir);
+        if (_chdir(dir) != 0) {
+    #else
+        mkdir(dir, 0755);
+        if (chdir(dir) != 0) {
+    #endif
+        perror("Error entering benchmark directory");
+        return false;
+    }
+    return true;
+}
+
+// Fills in record number index (from 0) of a generated data set; its key must be index + 1.
+typedef void (*bench_generator)(void *record, int index);
+// Makes the change the update benchmark writes back, as the menu's update would.
+typedef void (*bench_editor)(void *record);
+
+/*
+ * Fills store with records generated records, then times operations rounds
+ * each of loading and saving the whole file, finding a record by key, updating
+ * one and deleting one, with the same rs_ calls the menus make. Keys are picked
+ * with a fixed seed, so every run does the same work. The store holds the full
+ * generated set again afterwards. Returns false if the benchmark could not run
+ * or a lookup missed.
+ */
+static inline bool bench_runStore(const char *system, const struct RecordStore *store, int records, int operations,
+                                  bench_generator generate, bench_editor edit) {
+    unsigned char *generated = (unsigned char *)calloc(records, store->record_size);
+    unsigned char *loaded = (unsigned char *)malloc((size_t)records * store->record_size);
+    unsigned char *record = (unsigned char *)malloc(store->record_size);
+    double *samples = (double *)malloc(operations * sizeof(double));
+    if (generated == NULL || loaded == NULL || record == NULL || samples == NULL) {
+        printf("Error: Not enough memory for the benchmark.\n");
+        free(generated);
+        free(loaded);
+        free(record);
+        free(samples);
+        return false;
+    }
+    for (int i = 0; i < records; i++) generate(generated + (size_t)i * store->record_size, i);
+    rs_saveAll(store, generated, records);
+    srand(12345);
+
+    for (int op = 0; op < operations; op++) {
+        double start = bench_nowMicros();
+        rs_loadAll(store, loaded, records);
+        samples[op] = bench_nowMicros() - start;
+    }
+    bench_printResult(system, "load", records, samples, operations);
+
+    for (int op = 0; op < operations; op++) {
+        double start = bench_nowMicros();
+        rs_saveAll(store, generated, records);
+        samples[op] = bench_nowMicros() - start;
+    }
+    bench_printResult(system, "save", records, samples, operations);
+
+    int found = 0;
+    for (int op = 0; op < operations; op++) {
+        long long key = rand() % records + 1;
+        double start = bench_nowMicros();
+        if (rs_find(store, key, record)) found++;
+        samples[op] = bench_nowMicros() - start;
+    }
+    bench_printResult(system, "lookup", records, samples, operations);
+
+    for (int op = 0; op < operations; op++) {
+        long long key = rand() % records + 1;
+        double start = bench_nowMicros();
+        if (rs_find(store, key, record)) {
+            edit(record);
+            rs_update(store, record);
+        }
+        samples[op] = bench_nowMicros() - start;
+    }
+    bench_printResult(system, "update", records, samples, operations);
+
+    for (int op = 0; op < operations; op++) {
+        rs_saveAll(store, generated, records); // Untimed: every delete starts from the full file
+        long long key = rand() % records + 1;
+        double start = bench_nowMicros();
+        rs_delete(store, key);
+        samples[op] = bench_nowMicros() - start;
+    }
+    bench_printResult(system, "delete", records, samples, operations);
+
+    rs_saveAll(store, generated, records);
+    free(generated);
+    free(loaded);
+    free(record);
+    free(samples);
+    return found == operations;
+}
+
+#endif // BENCH_H
@@ -0,0 +1,678 @@
+#ifndef RECORD_STORE_H
+#define RECORD_STORE_H
+
+/*
+ * Fixed-size record files shared by the Bank, Library, Employee and Student
+ * systems. A store is a file of equal-sized records, optionally after a fixed
+ * header, each with an integer key at a known offset. Records are read and
+ * written in place by slot; a deleted record becomes a tombstone (all zero
+ * bytes, so key RS_TOMBSTONE) whose slot the next append reuses. Keys must
+ * therefore be positive.
+ *
+ * A store may also keep a key index: a sorted file of (key, slot) entries
+ * that turns lookups, updates and deletes into a binary search, plus a stack
+ * of tombstoned slots that appends pop instead of scanning for one. Without
+ * one, records are found by a chunked scan of the file.
+ *
+ * Also here: sorted files of fixed-size entries (binary search, insert and
+ * remove), used for on-disk key indexes.
+ *
+ * Whole-file saves go to a temporary file that is synced and then renamed
+ * over the store, so a crash leaves either the old or the new file. In-place
+ * edits are synced one by one, or, after rs_deferSync(true), once by rs_flush.
+ *
+ * Header-only so each program still builds from its single .cpp file.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdbool.h>
+
+#ifdef _WIN32
+    #include <windows.h>
+    #include <io.h>
+#else
+    #include <unistd.h>
+    #include <fcntl.h>
+#endif
+
+// --- Constants ---
+#define RS_TOMBSTONE 0 // Key of a deleted record
+#define RS_IO_CHUNK 256 // Records per read when scanning a store
+#define RS_LOAD_BLOCK 65536 // Most records one fread of rs_loadAll asks for
+#define RS_MAX_ENTRY_SIZE 512 // Largest entry of a sorted file
+#define RS_TEMP_SUFFIX ".tmp" // rs_saveAll writes here, then renames over the store
+#define RS_INDEX_MAGIC 0x58444952u // "RIDX": first bytes of a key index file
+
+// --- Structure Definition ---
+struct RecordStore {
+    const char *filename;
+    size_t record_size;
+    size_t key_offset;  // offsetof() the key field in the record
+    size_t key_size;    // sizeof(int) or sizeof(long long)
+    long header_size;   // Bytes before the first record
+    const void *header; // Written at the start of a new or fully rewritten file; NULL: keep the file's own
+    const char *index_filename; // Key index (see rs_openIndex); NULL: records are found by scanning
+    const char *free_filename;  // Tombstoned slots for appends to reuse; kept with the key index
+};
+
+// Starts a key index file. clean is set only while the index and the free list
+// match the data file, which was data_size bytes then; it is cleared before
+// either is edited, so an index a crash left half-updated gets rebuilt.
+struct RsIndexHeader {
+    unsigned int magic; // RS_INDEX_MAGIC
+    unsigned int clean;
+    long long data_size;
+};
+
+// One key index entry; the entries follow the header, sorted by key.
+struct RsIndexEntry {
+    long long key;
+    long long slot;
+};
+
+// Compares two entries of a sorted file
+typedef int (*rs_entryCompare)(const void *a, const void *b);
+
+static bool rs_defer_sync = false;  // In-place edits wait for rs_flush instead of syncing each time
+static bool rs_sync_pending = false; // An edit has been written but not synced
+
+// --- File Helpers ---
+static inline void rs_syncFile(FILE *fp) {
+    fflush(fp);
+    #ifdef _WIN32
+        _commit(_fileno(fp));
+    #else
+        fsync(fileno(fp));
+    #endif
+}
+
+static inline void rs_truncateFile(FILE *fp, long size) {
+    fflush(fp);
+    #ifdef _WIN32
+        _chsize(_fileno(fp), size);
+    #else
+        if (ftruncate(fileno(fp), size) != 0) {
+            perror("Error truncating file");
+        }
+    #endif
+}
+
+// Atomically puts temp_filename in place of filename, then makes the rename itself
+// durable by syncing the directory (the current one, where every store lives).
+static inline bool rs_replaceFile(const char *temp_filename, const char *filename) {
+    #ifdef _WIN32
+        return MoveFileExA(temp_filename, filename, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+    #else
+        if (rename(temp_filename, filename) != 0) return false;
+        int dir = open(".", O_RDONLY);
+        if (dir >= 0) {
+            fsync(dir);
+            close(dir);
+        }
+        return true;
+    #endif
+}
+
+// Number of whole entries of entry_size bytes in a headerless file.
+static inline long rs_countRecords(FILE *fp, size_t entry_size) {
+    if (fseek(fp, 0, SEEK_END) != 0) return 0;
+    long size = ftell(fp);
+    return size < 0 ? 0 : size / (long)entry_size;
+}
+
+// --- Slot Access (fp opened by the caller) ---
+static inline long rs_slotOffset(const struct RecordStore *store, long slot) {
+    return store->header_size + slot * (long)store->record_size;
+}
+
+// Number of record slots (live or tombstoned) after the header.
+static inline long rs_countSlots(const struct RecordStore *store, FILE *fp) {
+    if (fseek(fp, 0, SEEK_END) != 0) return 0;
+    long size = ftell(fp) - store->header_size;
+    return size <= 0 ? 0 : size / (long)store->record_size;
+}
+
+static inline bool rs_readAt(const struct RecordStore *store, FILE *fp, long slot, void *rec) {
+    if (fseek(fp, rs_slotOffset(store, slot), SEEK_SET) != 0) return false;
+    return fread(rec, store->record_size, 1, fp) == 1;
+}
+
+// Overwrites one record; fp must be opened with "r+b". slot == count appends.
+static inline bool rs_writeAt(const struct RecordStore *store, FILE *fp, long slot, const void *rec) {
+    if (fseek(fp, rs_slotOffset(store, slot), SEEK_SET) != 0) return false;
+    return fwrite(rec, store->record_size, 1, fp) == 1;
+}
+
+static inline long long rs_keyOf(const struct RecordStore *store, const void *rec) {
+    const unsigned char *field = (const unsigned char *)rec + store->key_offset;
+    if (store->key_size == sizeof(int)) {
+        int key;
+        memcpy(&key, field, sizeof(key));
+        return key;
+    }
+    long long key;
+    memcpy(&key, field, sizeof(key));
+    return key;
+}
+
+// Slot of the first record with the key (RS_TOMBSTONE finds a free slot), or -1.
+// Reads a chunk of records at a time and only looks at their keys.
+static inline long rs_findSlot(const struct RecordStore *store, FILE *fp, long long key) {
+    unsigned char *chunk = (unsigned char *)malloc(RS_IO_CHUNK * store->record_size);
+    if (chunk == NULL || fseek(fp, store->header_size, SEEK_SET) != 0) {
+        free(chunk);
+        return -1;
+    }
+    long slot = 0, found = -1;
+    size_t n;
+    while (found < 0 && (n = fread(chunk, store->record_size, RS_IO_CHUNK, fp)) > 0) {
+        for (size_t i = 0; i < n; i++) {
+            if (rs_keyOf(store, chunk + i * store->record_size) == key) {
+                found = slot + (long)i;
+                break;
+            }
+        }
+        slot += (long)n;
+    }
+    free(chunk);
+    return found;
+}
+
+// --- Sorted Files ---
+// A sorted file holds entries of entry_size bytes from offset base on; the *At
+// versions work on an open file, which may start with a header.
+
+// Number of whole entries after base.
+static inline long rs_sortedCount(FILE *fp, long base, size_t entry_size) {
+    if (fseek(fp, 0, SEEK_END) != 0) return 0;
+    long size = ftell(fp) - base;
+    return size <= 0 ? 0 : size / (long)entry_size;
+}
+
+// Returns the position of the first entry that does not compare less than probe.
+static inline long rs_sortedLowerBoundAt(FILE *fp, long base, const void *probe, size_t entry_size, long entry_count,
+                                         rs_entryCompare compare) {
+    long low = 0, high = entry_count;
+    unsigned char entry[RS_MAX_ENTRY_SIZE];
+    while (low < high) {
+        long mid = low + (high - low) / 2;
+        fseek(fp, base + mid * (long)entry_size, SEEK_SET);
+        if (fread(entry, entry_size, 1, fp) != 1) break;
+        if (compare(entry, probe) < 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+static inline long rs_sortedLowerBound(FILE *fp, const void *probe, size_t entry_size, long entry_count, rs_entryCompare compare) {
+    return rs_sortedLowerBoundAt(fp, 0, probe, entry_size, entry_count, compare);
+}
+
+// Inserts an entry at its sorted position; only the entries after it are rewritten.
+static inline bool rs_sortedInsertAt(FILE *fp, long base, const void *entry, size_t entry_size, rs_entryCompare compare) {
+    long entry_count = rs_sortedCount(fp, base, entry_size);
+    long pos = rs_sortedLowerBoundAt(fp, base, entry, entry_size, entry_count, compare);
+    long tail_count = entry_count - pos;
+    unsigned char *tail = (unsigned char *)malloc((tail_count > 0 ? tail_count : 1) * entry_size);
+    if (tail == NULL) {
+        printf("Error: Not enough memory to update the index.\n");
+        return false;
+    }
+    fseek(fp, base + pos * (long)entry_size, SEEK_SET);
+    tail_count = (long)fread(tail, entry_size, tail_count, fp);
+
+    fseek(fp, base + pos * (long)entry_size, SEEK_SET);
+    bool ok = fwrite(entry, entry_size, 1, fp) == 1 && fwrite(tail, entry_size, tail_count, fp) == (size_t)tail_count;
+    free(tail);
+    return ok;
+}
+
+static inline bool rs_sortedInsert(const char *filename, const void *entry, size_t entry_size, rs_entryCompare compare) {
+    FILE *fp = fopen(filename, "r+b");
+    if (fp == NULL) fp = fopen(filename, "w+b");
+    if (fp == NULL) {
+        perror("Error opening file for updating index");
+        return false;
+    }
+    bool ok = rs_sortedInsertAt(fp, 0, entry, entry_size, compare);
+    fclose(fp);
+    return ok;
+}
+
+// Removes the entry that compares equal to the one given by moving the entries after it down.
+static inline bool rs_sortedRemoveAt(FILE *fp, long base, const void *entry, size_t entry_size, rs_entryCompare compare) {
+    long entry_count = rs_sortedCount(fp, base, entry_size);
+    long pos = rs_sortedLowerBoundAt(fp, base, entry, entry_size, entry_count, compare);
+    unsigned char found[RS_MAX_ENTRY_SIZE];
+    if (pos >= entry_count || fseek(fp, base + pos * (long)entry_size, SEEK_SET) != 0 ||
+        fread(found, entry_size, 1, fp) != 1 || compare(found, entry) != 0) {
+        return false;
+    }
+
+    long tail_count = entry_count - pos - 1;
+    unsigned char *tail = (unsigned char *)malloc((tail_count > 0 ? tail_count : 1) * entry_size);
+    if (tail == NULL) {
+        printf("Error: Not enough memory to update the index.\n");
+        return false;
+    }
+    tail_count = (long)fread(tail, entry_size, tail_count, fp);
+    fseek(fp, base + pos * (long)entry_size, SEEK_SET);
+    bool ok = fwrite(tail, entry_size, tail_count, fp) == (size_t)tail_count;
+    rs_truncateFile(fp, base + (entry_count - 1) * (long)entry_size);
+    free(tail);
+    return ok;
+}
+
+static inline bool rs_sortedRemove(const char *filename, const void *entry, size_t entry_size, rs_entryCompare compare) {
+    FILE *fp = fopen(filename, "r+b");
+    if (fp == NULL) return false;
+    bool ok = rs_sortedRemoveAt(fp, 0, entry, entry_size, compare);
+    fclose(fp);
+    return ok;
+}
+
+// --- Key Index ---
+// index_filename holds an RsIndexHeader and then one RsIndexEntry per live
+// record, sorted by key; free_filename is a stack of tombstoned slots (long
+// long each, the next to reuse last). rs_openIndex checks both at startup;
+// after that the store's functions keep them up to date.
+
+static inline int rs_compareIndexEntries(const void *a, const void *b) {
+    long long lhs = ((const struct RsIndexEntry *)a)->key, rhs = ((const struct RsIndexEntry *)b)->key;
+    return (lhs > rhs) - (lhs < rhs);
+}
+
+// Size of a file in bytes, or -1 if it does not exist.
+static inline long rs_fileSize(const char *filename) {
+    FILE *fp = fopen(filename, "rb");
+    if (fp == NULL) return -1;
+    long size = fseek(fp, 0, SEEK_END) == 0 ? ftell(fp) : -1;
+    fclose(fp);
+    return size;
+}
+
+// Rewrites the header at the start of an open index file and syncs it.
+static inline bool rs_writeIndexHeader(FILE *idx, bool clean, long data_size) {
+    struct RsIndexHeader header = { RS_INDEX_MAGIC, clean ? 1u : 0u, data_size };
+    if (fseek(idx, 0, SEEK_SET) != 0 || fwrite(&header, sizeof(header), 1, idx) != 1) return false;
+    rs_syncFile(idx);
+    return true;
+}
+
+// Clears the clean flag, durably, before the index or free list is edited.
+static inline void rs_markIndexDirty(const struct RecordStore *store) {
+    FILE *idx = fopen(store->index_filename, "r+b");
+    if (idx == NULL) return;
+    struct RsIndexHeader header;
+    if (fread(&header, sizeof(header), 1, idx) == 1 && header.clean) {
+        rs_writeIndexHeader(idx, false, header.data_size);
+    }
+    fclose(idx);
+}
+
+// Replaces the index and free list: entries (sorted here) and free_slots, the
+// slot to reuse first being the last one.
+static inline bool rs_writeIndex(const struct RecordStore *store, struct RsIndexEntry *entries, long count,
+                                 const long long *free_slots, long free_count) {
+    rs_markIndexDirty(store); // The old index must not pass for current while the free list changes
+    FILE *free_list = fopen(store->free_filename, "wb");
+    bool ok = free_list != NULL &&
+              (free_count == 0 || fwrite(free_slots, sizeof(long long), free_count, free_list) == (size_t)free_count);
+    if (free_list != NULL) {
+        rs_syncFile(free_list);
+        if (fclose(free_list) != 0) ok = false;
+    }
+
+    qsort(entries, count, sizeof(struct RsIndexEntry), rs_compareIndexEntries);
+    char temp_filename[FILENAME_MAX];
+    snprintf(temp_filename, sizeof(temp_filename), "%s" RS_TEMP_SUFFIX, store->index_filename);
+    FILE *idx = ok ? fopen(temp_filename, "w+b") : NULL;
+    ok = idx != NULL && rs_writeIndexHeader(idx, true, rs_fileSize(store->filename)) &&
+         fwrite(entries, sizeof(struct RsIndexEntry), count, idx) == (size_t)count;
+    if (idx != NULL) {
+        rs_syncFile(idx);
+        if (fclose(idx) != 0) ok = false;
+    }
+    if (!ok || !rs_replaceFile(temp_filename, store->index_filename)) {
+        perror("Error saving index");
+        remove(temp_filename);
+        remove(store->index_filename); // Lookups scan until the next rs_openIndex rebuilds it
+        return false;
+    }
+    return true;
+}
+
+// Builds the index and free list from one pass over the data file.
+static inline bool rs_rebuildIndex(const struct RecordStore *store) {
+    FILE *fp = fopen(store->filename, "rb");
+    long slots = fp != NULL ? rs_countSlots(store, fp) : 0;
+    struct RsIndexEntry *entries = (struct RsIndexEntry *)malloc((slots > 0 ? slots : 1) * sizeof(struct RsIndexEntry));
+    long long *free_slots = (long long *)malloc((slots > 0 ? slots : 1) * sizeof(long long));
+    unsigned char *chunk = (unsigned char *)malloc(RS_IO_CHUNK * store->record_size);
+    long count = 0, free_count = 0, slot = 0;
+    bool ok = entries != NULL && free_slots != NULL && chunk != NULL;
+    if (!ok) printf("Error: Not enough memory to build the index of %s.\n", store->filename);
+    if (ok && fp != NULL && fseek(fp, store->header_size, SEEK_SET) == 0) {
+        size_t n;
+        while (slot < slots && (n = fread(chunk, store->record_size, RS_IO_CHUNK, fp)) > 0) {
+            for (size_t i = 0; i < n && slot < slots; i++, slot++) {
+                long long key = rs_keyOf(store, chunk + i * store->record_size);
+                if (key == RS_TOMBSTONE) {
+                    free_slots[free_count++] = slot;
+                } else {
+                    entries[count].key = key;
+                    entries[count++].slot = slot;
+                }
+            }
+        }
+    }
+    if (fp != NULL) fclose(fp);
+    free(chunk);
+    for (long i = 0; i < free_count / 2; i++) { // Lowest slot last, so it is reused first
+        long long swap = free_slots[i];
+        free_slots[i] = free_slots[free_count - 1 - i];
+        free_slots[free_count - 1 - i] = swap;
+    }
+    ok = ok && rs_writeIndex(store, entries, count, free_slots, free_count);
+    free(entries);
+    free(free_slots);
+    return ok;
+}
+
+// Checks the key index once at startup, before the store is used, and rebuilds
+// it when it is missing, was left mid-edit, or does not match the data file.
+static inline void rs_openIndex(const struct RecordStore *store) {
+    if (store->index_filename == NULL) return;
+    struct RsIndexHeader header;
+    FILE *idx = fopen(store->index_filename, "rb");
+    bool current = idx != NULL && fread(&header, sizeof(header), 1, idx) == 1 && header.magic == RS_INDEX_MAGIC &&
+                   header.clean && header.data_size == rs_fileSize(store->filename) &&
+                   rs_fileSize(store->free_filename) >= 0;
+    if (idx != NULL) fclose(idx);
+    if (!current) rs_rebuildIndex(store);
+}
+
+// Removes the index and free list, e.g. after the data file was replaced
+// behind the store's back; the next rs_openIndex rebuilds them.
+static inline void rs_dropIndex(const struct RecordStore *store) {
+    if (store->index_filename == NULL) return;
+    remove(store->index_filename);
+    remove(store->free_filename);
+}
+
+// Slot of the key according to the index: -1 if the key is not there, -2 if
+// there is no usable index.
+static inline long rs_indexSlot(const struct RecordStore *store, long long key) {
+    FILE *idx = fopen(store->index_filename, "rb");
+    if (idx == NULL) return -2;
+    long base = (long)sizeof(struct RsIndexHeader);
+    long count = rs_sortedCount(idx, base, sizeof(struct RsIndexEntry));
+    struct RsIndexEntry probe = { key, 0 }, entry;
+    long pos = rs_sortedLowerBoundAt(idx, base, &probe, sizeof(struct RsIndexEntry), count, rs_compareIndexEntries);
+    bool found = pos < count && fseek(idx, base + pos * (long)sizeof(struct RsIndexEntry), SEEK_SET) == 0 &&
+                 fread(&entry, sizeof(entry), 1, idx) == 1 && entry.key == key;
+    fclose(idx);
+    return found ? (long)entry.slot : -1;
+}
+
+// Adds (add) or removes the entry for key at slot.
+static inline bool rs_indexEdit(const struct RecordStore *store, long long key, long slot, bool add) {
+    FILE *idx = fopen(store->index_filename, "r+b");
+    if (idx == NULL) return false;
+    struct RsIndexEntry entry = { key, slot };
+    long base = (long)sizeof(struct RsIndexHeader);
+    bool ok = add ? rs_sortedInsertAt(idx, base, &entry, sizeof(entry), rs_compareIndexEntries)
+                  : rs_sortedRemoveAt(idx, base, &entry, sizeof(entry), rs_compareIndexEntries);
+    fclose(idx);
+    return ok;
+}
+
+// Takes the slot to reuse off the free list; -1 if it is empty.
+static inline long rs_popFreeSlot(const struct RecordStore *store) {
+    FILE *fp = fopen(store->free_filename, "r+b");
+    if (fp == NULL) return -1;
+    long count = rs_countRecords(fp, sizeof(long long));
+    long long slot = -1;
+    if (count > 0 && fseek(fp, (count - 1) * (long)sizeof(long long), SEEK_SET) == 0 &&
+        fread(&slot, sizeof(slot), 1, fp) == 1) {
+        rs_truncateFile(fp, (count - 1) * (long)sizeof(long long));
+    } else {
+        slot = -1;
+    }
+    fclose(fp);
+    return (long)slot;
+}
+
+static inline void rs_pushFreeSlot(const struct RecordStore *store, long slot) {
+    FILE *fp = fopen(store->free_filename, "ab");
+    long long entry = slot;
+    if (fp == NULL || fwrite(&entry, sizeof(entry), 1, fp) != 1) perror("Error updating free slot list");
+    if (fp != NULL) fclose(fp);
+}
+
+// Slot of the live record with the key, or -1: from the index when the store
+// has one, by scanning fp otherwise (or if the index points at another record).
+static inline long rs_keySlot(const struct RecordStore *store, FILE *fp, long long key) {
+    if (store->index_filename == NULL) return rs_findSlot(store, fp, key);
+    long slot = rs_indexSlot(store, key);
+    if (slot == -1) return -1;
+    unsigned char field[sizeof(long long)];
+    long long stored = RS_TOMBSTONE;
+    if (slot >= 0 && fseek(fp, rs_slotOffset(store, slot) + (long)store->key_offset, SEEK_SET) == 0 &&
+        fread(field, store->key_size, 1, fp) == 1) {
+        stored = rs_keyOf(store, field - store->key_offset);
+    }
+    return stored == key ? slot : rs_findSlot(store, fp, key);
+}
+
+// --- Whole-Record Operations (open store->filename themselves) ---
+
+// Reads every live record into records (at most max_records); returns how many.
+// The slot count comes from the file size, and records are read straight into
+// the array in blocks of RS_LOAD_BLOCK, with tombstones squeezed out as they go.
+static inline int rs_loadAll(const struct RecordStore *store, void *records, int max_records) {
+    FILE *fp = fopen(store->filename, "rb");
+    if (fp == NULL) return 0; // File doesn't exist yet
+
+    long slots = rs_countSlots(store, fp);
+    long size = ftell(fp);
+    if (size > rs_slotOffset(store, slots)) {
+        printf("Warning: %s ends with a partial record, which was ignored.\n", store->filename);
+    }
+    unsigned char *dest = (unsigned char *)records;
+    int count = 0;
+    fseek(fp, store->header_size, SEEK_SET);
+    while (count < max_records && slots > 0) {
+        long block = max_records - count;
+        if (block > slots) block = slots;
+        if (block > RS_LOAD_BLOCK) block = RS_LOAD_BLOCK;
+        unsigned char *start = dest + (size_t)count * store->record_size;
+        long n = (long)fread(start, store->record_size, block, fp);
+        for (long i = 0; i < n; i++) {
+            unsigned char *rec = start + (size_t)i * store->record_size;
+            if (rs_keyOf(store, rec) == RS_TOMBSTONE) continue;
+            unsigned char *to = dest + (size_t)count * store->record_size;
+            if (to != rec) memcpy(to, rec, store->record_size);
+            count++;
+        }
+        if (n < block) break; // Shorter than its size said: changed while we read
+        slots -= n;
+    }
+    fclose(fp);
+    return count;
+}
+
+// Replaces the whole file with the given records (and no tombstones). The old
+// file stays untouched until the new one is complete and synced. The key index
+// is rewritten to match: record i is in slot i.
+static inline bool rs_saveAll(const struct RecordStore *store, const void *records, int count) {
+    char temp_filename[FILENAME_MAX];
+    snprintf(temp_filename, sizeof(temp_filename), "%s" RS_TEMP_SUFFIX, store->filename);
+    unsigned char *header = (unsigned char *)calloc(1, store->header_size > 0 ? store->header_size : 1);
+    if (header != NULL && store->header != NULL) {
+        memcpy(header, store->header, store->header_size);
+    } else if (header != NULL && store->header_size > 0) {
+        FILE *old = fopen(store->filename, "rb");
+        if (old != NULL) {
+            if (fread(header, store->header_size, 1, old) != 1) memset(header, 0, store->header_size);
+            fclose(old);
+        }
+    }
+    if (store->index_filename != NULL) rs_markIndexDirty(store);
+    FILE *fp = header != NULL ? fopen(temp_filename, "wb") : NULL;
+    if (fp == NULL) {
+        perror("Error opening file for saving records");
+        free(header);
+        return false;
+    }
+    bool ok = fwrite(header, 1, store->header_size, fp) == (size_t)store->header_size &&
+              fwrite(records, store->record_size, count, fp) == (size_t)count;
+    free(header);
+    if (ok) rs_syncFile(fp);
+    if (fclose(fp) != 0) ok = false;
+    if (!ok || !rs_replaceFile(temp_filename, store->filename)) {
+        perror("Error saving records");
+        remove(temp_filename);
+        return false;
+    }
+    if (store->index_filename != NULL) {
+        struct RsIndexEntry *entries = (struct RsIndexEntry *)malloc((count > 0 ? count : 1) * sizeof(struct RsIndexEntry));
+        for (int i = 0; entries != NULL && i < count; i++) {
+            entries[i].key = rs_keyOf(store, (const unsigned char *)records + (size_t)i * store->record_size);
+            entries[i].slot = i;
+        }
+        if (entries == NULL || !rs_writeIndex(store, entries, count, NULL, 0)) rs_dropIndex(store);
+        free(entries);
+    }
+    return true;
+}
+
+// Chooses whether in-place edits are synced one by one (the default) or
+// coalesced until rs_flush; either way each edit reaches the file at once.
+static inline void rs_deferSync(bool defer) {
+    rs_defer_sync = defer;
+}
+
+// Syncs edits held back by rs_deferSync, then the key index and free list,
+// which are marked clean again; call before exiting.
+static inline void rs_flush(const struct RecordStore *store) {
+    if (rs_sync_pending) {
+        FILE *fp = fopen(store->filename, "r+b");
+        if (fp != NULL) {
+            rs_syncFile(fp);
+            fclose(fp);
+        }
+        rs_sync_pending = false;
+    }
+    if (store->index_filename == NULL) return;
+    struct RsIndexHeader header;
+    FILE *idx = fopen(store->index_filename, "r+b");
+    if (idx == NULL) return;
+    if (fread(&header, sizeof(header), 1, idx) == 1 && !header.clean) {
+        FILE *free_list = fopen(store->free_filename, "r+b");
+        if (free_list != NULL) {
+            rs_syncFile(free_list);
+            fclose(free_list);
+        }
+        rs_syncFile(idx); // The entries are durable before the header says so
+        rs_writeIndexHeader(idx, true, rs_fileSize(store->filename));
+    }
+    fclose(idx);
+}
+
+// Ends an in-place edit of fp: syncs it now, or leaves it for rs_flush.
+static inline bool rs_finishEdit(FILE *fp, bool ok) {
+    if (ok && rs_defer_sync) {
+        rs_sync_pending = true;
+    } else if (ok) {
+        rs_syncFile(fp);
+    }
+    if (fclose(fp) != 0) ok = false;
+    return ok;
+}
+
+// Finds the live record with the key; false if there is none.
+static inline bool rs_find(const struct RecordStore *store, long long key, void *rec) {
+    FILE *fp = fopen(store->filename, "rb");
+    if (fp == NULL) return false;
+    long slot = rs_keySlot(store, fp, key);
+    bool found = slot >= 0 && rs_readAt(store, fp, slot, rec);
+    fclose(fp);
+    return found;
+}
+
+// Stores a new record in a tombstoned slot (the one the free list gives, or the
+// first one in the file if there is no key index), or at the end of the file (a
+// new file starts with store->header). Returns the slot, or -1 on failure. The
+// caller has checked that the key is not in use.
+static inline long rs_append(const struct RecordStore *store, const void *rec) {
+    FILE *fp = fopen(store->filename, "r+b");
+    if (fp == NULL) fp = fopen(store->filename, "w+b");
+    if (fp == NULL) {
+        perror("Error opening file for adding a record");
+        return -1;
+    }
+    bool ok = true;
+    if (fseek(fp, 0, SEEK_END) == 0 && ftell(fp) == 0 && store->header_size > 0) {
+        ok = store->header != NULL && fwrite(store->header, store->header_size, 1, fp) == 1;
+    }
+    long slot_count = rs_countSlots(store, fp), slot;
+    if (store->index_filename != NULL) {
+        rs_markIndexDirty(store);
+        slot = rs_popFreeSlot(store);
+        if (slot >= slot_count) slot = -1;
+    } else {
+        slot = rs_findSlot(store, fp, RS_TOMBSTONE);
+    }
+    if (slot < 0) slot = slot_count;
+    ok = rs_finishEdit(fp, ok && rs_writeAt(store, fp, slot, rec));
+    if (ok && store->index_filename != NULL) rs_indexEdit(store, rs_keyOf(store, rec), slot, true);
+    return ok ? slot : -1;
+}
+
+// Overwrites the record with the same key in place. Returns its slot, or -1 if
+// it does not exist or cannot be written.
+static inline long rs_update(const struct RecordStore *store, const void *rec) {
+    FILE *fp = fopen(store->filename, "r+b");
+    if (fp == NULL) return -1;
+    long slot = rs_keySlot(store, fp, rs_keyOf(store, rec));
+    return rs_finishEdit(fp, slot >= 0 && rs_writeAt(store, fp, slot, rec)) ? slot : -1;
+}
+
+// Overwrites field_size bytes at field_offset within the record with the key,
+// leaving the rest of the record untouched. Returns its slot, or -1 if it does
+// not exist or cannot be written.
+static inline long rs_updateField(const struct RecordStore *store, long long key, size_t field_offset,
+                                  size_t field_size, const void *value) {
+    FILE *fp = fopen(store->filename, "r+b");
+    if (fp == NULL) return -1;
+    long slot = rs_keySlot(store, fp, key);
+    bool ok = slot >= 0 && fseek(fp, rs_slotOffset(store, slot) + (long)field_offset, SEEK_SET) == 0 &&
+              fwrite(value, field_size, 1, fp) == 1;
+    return rs_finishEdit(fp, ok) ? slot : -1;
+}
+
+// Turns the record with the key into a tombstone; false if it does not exist.
+static inline bool rs_delete(const struct RecordStore *store, long long key) {
+    FILE *fp = fopen(store->filename, "r+b");
+    if (fp == NULL) return false;
+    long slot = rs_keySlot(store, fp, key);
+    if (slot >= 0 && store->index_filename != NULL) rs_markIndexDirty(store);
+    unsigned char *tombstone = (unsigned char *)calloc(1, store->record_size);
+    bool ok = slot >= 0 && tombstone != NULL && rs_writeAt(store, fp, slot, tombstone);
+    free(tombstone);
+    ok = rs_finishEdit(fp, ok);
+    if (ok && store->index_filename != NULL) {
+        rs_indexEdit(store, key, slot, false);
+        rs_pushFreeSlot(store, slot);
+    }
+    return ok;
+}
+
+#endif // RECORD_STORE_H